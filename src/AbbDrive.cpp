@@ -0,0 +1,151 @@
+/*
+ * AbbDrive.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "AbbDrive.h"
+
+typedef AbbRegisters Abb;
+
+AbbDrive::AbbDrive(ModbusMaster &node, uint32_t statusPeriodMs) :
+	node(node), statusPeriodMs(statusPeriodMs), lastStatusTime(0), run(false),
+	startTime(0), startupMs(0), state(UNKNOWN), control(0), controlPending(false),
+	controlTime(0), speed(0), referencePending(false), requested(0), written(0),
+	writeTime(0), leftSetpoint(false), confirmed(0), status(0), statusValid(false), transactions(0), errors(0), trips(0), lastResult(0) {
+}
+
+void AbbDrive::start() {
+	run = true;
+	startTime = millis();
+	startupMs = 0;
+	command(Abb::CW_STOP, startTime);
+}
+
+void AbbDrive::stop() {
+	run = false;
+	command(Abb::CW_STOP, millis());
+}
+
+/* Writing the same reference again is not needed; the existing ticket
+ * stays valid and may already be confirmed.
+ */
+uint32_t AbbDrive::setSpeed(uint8_t percent) {
+	if(percent != speed || requested == 0) {
+		speed = percent;
+		referencePending = true;
+		requested++;
+	}
+	return requested;
+}
+
+void AbbDrive::command(uint16_t word, uint32_t now) {
+	control = word;
+	controlPending = true;
+	controlTime = now;
+}
+
+AbbDrive::State AbbDrive::decode(uint16_t status) {
+	if(status & Abb::SW_TRIPPED) return FAULT;
+	if(status & Abb::SW_SWC_ON_INHIB) return SWITCH_ON_INHIBITED;
+	if(status & Abb::SW_RDY_REF) return OPERATION_ENABLED;
+	if(status & Abb::SW_RDY_RUN) return READY_TO_OPERATE;
+	if(status & Abb::SW_RDY_ON) return READY_TO_SWITCH_ON;
+	return NOT_READY;
+}
+
+/* Choose the control word that moves the drive from the state just read
+ * to the next one. A command is repeated only if the drive has not left
+ * the state for a while, so a slow drive is not flooded with writes.
+ */
+void AbbDrive::advance(uint32_t now) {
+	State previous = state;
+	uint16_t next;
+
+	state = decode(status);
+	if(state == FAULT) {
+		if(previous != FAULT) trips++;
+		// reset needs a rising edge of CW_RESET: drop it first, then set it
+		if(control == Abb::CW_FAULT_RESET) {
+			if(now - controlTime >= RESET_RETRY_MS) command(Abb::CW_STOP, now);
+		}
+		else if(previous != FAULT || now - controlTime >= RESET_RETRY_MS) {
+			command(Abb::CW_FAULT_RESET, now);
+		}
+		return;
+	}
+	if(!run) {
+		if(state == OPERATION_ENABLED || state == READY_TO_OPERATE) next = Abb::CW_STOP;
+		else return;
+	}
+	else {
+		switch(state) {
+		case OPERATION_ENABLED:
+			if(previous != OPERATION_ENABLED) {
+				if(startupMs == 0) startupMs = now - startTime;
+				referencePending = true;	// also after the drive has tripped
+			}
+			return;
+		case READY_TO_SWITCH_ON:
+		case READY_TO_OPERATE:
+			next = Abb::CW_RUN;
+			break;
+		default:		// NOT_READY, SWITCH_ON_INHIBITED
+			next = Abb::CW_STOP;
+			break;
+		}
+	}
+	if(next != control || (state == previous && now - controlTime >= CONTROL_RETRY_MS)) {
+		command(next, now);
+	}
+}
+
+/* A control word takes priority over the reference, the reference over
+ * the status poll. The status word is read on every pass until the drive
+ * runs and right after each write, otherwise every statusPeriodMs.
+ */
+void AbbDrive::poll() {
+	uint32_t now = millis();
+
+	if(controlPending) {
+		transactions++;
+		lastResult = node.writeRegister<Abb::ControlWord>(control);
+		if(lastResult == node.ku8MBSuccess) {
+			controlPending = false;
+			lastStatusTime = now - statusPeriodMs;
+		}
+		else errors++;
+		return;
+	}
+	if(referencePending && state == OPERATION_ENABLED) {
+		uint32_t ticket = requested;
+		transactions++;
+		lastResult = node.writeRegister<Abb::SpeedReference>(speed);
+		if(lastResult == node.ku8MBSuccess) {
+			referencePending = false;
+			written = ticket;
+			writeTime = now;
+			leftSetpoint = false;
+			lastStatusTime = now - statusPeriodMs;
+		}
+		else errors++;
+		return;
+	}
+	if(state == OPERATION_ENABLED && now - lastStatusTime < statusPeriodMs) return;
+
+	lastStatusTime = now;
+	transactions++;
+	lastResult = node.readRegister<Abb::StatusWord>(status);
+	if(lastResult == node.ku8MBSuccess) {
+		statusValid = true;
+		advance(now);
+		if(state == OPERATION_ENABLED && !referencePending) {
+			if(!(status & Abb::SW_AT_SETPOINT)) leftSetpoint = true;
+			else if(leftSetpoint || now - writeTime >= SETPOINT_SETTLE_MS) confirmed = written;
+		}
+	}
+	else {
+		statusValid = false;
+		errors++;
+	}
+}
@@ -0,0 +1,92 @@
+/*
+ * AbbDrive.h
+ *
+ *  Created on: 19.10.2026
+ *
+ * ABB frequency converter on Modbus. setSpeed() only records the new
+ * reference and returns a ticket; poll(), called once per main loop pass,
+ * performs at most one Modbus transaction: a pending control word, then a
+ * pending reference write, otherwise a read of the status word. The
+ * at-setpoint bit (0x0100) seen by a status read after a write confirms
+ * that write's ticket, so the caller checks a flag instead of blocking.
+ * Right after a write the bit may still refer to the old reference, so it
+ * only counts once it has been seen clear since the write, or after
+ * SETPOINT_SETTLE_MS for a step too small to clear it.
+ *
+ * The status word also drives the ABB Drives profile state machine. After
+ * start() every status read moves the drive one step further towards
+ * OPERATION ENABLED as soon as it reports the previous state, instead of
+ * waiting a fixed time. A trip is reset with a rising edge of control word
+ * bit 7 and the drive is brought back up, with the reference written again,
+ * without a reboot.
+ */
+
+#ifndef ABBDRIVE_H_
+#define ABBDRIVE_H_
+
+#include "ModbusMaster.h"
+#include "AbbRegisters.h"
+
+class AbbDrive {
+public:
+	enum State {
+		UNKNOWN,				// no status read yet
+		NOT_READY,				// not ready to switch on
+		SWITCH_ON_INHIBITED,
+		READY_TO_SWITCH_ON,
+		READY_TO_OPERATE,
+		OPERATION_ENABLED,
+		FAULT
+	};
+
+	AbbDrive(ModbusMaster &node, uint32_t statusPeriodMs = 100);
+	void start();
+	void stop();
+	uint32_t setSpeed(uint8_t percent);
+	void poll();
+	State getState() const { return state; }
+	bool isRunning() const { return state == OPERATION_ENABLED; }
+	bool isConfirmed(uint32_t ticket) const { return (int32_t)(confirmed - ticket) >= 0; }
+	bool atSetpoint() const { return isConfirmed(written) && written == requested; }
+	uint16_t getStatus() const { return status; }
+	bool isStatusValid() const { return statusValid; }
+	uint32_t getTransactions() const { return transactions; }
+	uint32_t getErrors() const { return errors; }		// failed transactions
+	uint8_t getLastResult() const { return lastResult; }	// ModbusMaster status of the latest transaction
+	uint32_t getTrips() const { return trips; }
+	uint32_t getStartupMs() const { return startupMs; }	// start() to OPERATION ENABLED, 0 until reached
+private:
+	static const uint32_t CONTROL_RETRY_MS = 500;	// repeat a command the drive did not follow
+	static const uint32_t RESET_RETRY_MS = 1000;	// a fault that does not clear is reset again
+	static const uint32_t SETPOINT_SETTLE_MS = 500;	// the at-setpoint bit may lag a write by this much
+
+	static State decode(uint16_t status);
+	void advance(uint32_t now);
+	void command(uint16_t word, uint32_t now);
+
+	ModbusMaster &node;
+	uint32_t statusPeriodMs;
+	uint32_t lastStatusTime;
+	bool run;				// start() requested
+	uint32_t startTime;
+	uint32_t startupMs;
+	State state;
+	uint16_t control;		// control word to write, or last written
+	bool controlPending;
+	uint32_t controlTime;	// when control was last written
+	uint8_t speed;			// latest requested reference, %
+	bool referencePending;
+	uint32_t requested;		// ticket of the latest setSpeed()
+	uint32_t written;		// ticket of the latest reference that reached the drive
+	uint32_t writeTime;		// when it was written
+	bool leftSetpoint;		// at-setpoint bit seen clear since then
+	uint32_t confirmed;		// latest ticket confirmed at setpoint
+	uint16_t status;
+	bool statusValid;
+	uint32_t transactions;
+	uint32_t errors;
+	uint32_t trips;
+	uint8_t lastResult;
+};
+
+#endif /* ABBDRIVE_H_ */
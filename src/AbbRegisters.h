@@ -0,0 +1,63 @@
+/*
+ * AbbRegisters.h
+ *
+ *  Created on: 19.10.2026
+ *
+ * Register map of the ABB drive in the ABB Drives profile, as used over
+ * Modbus. Addresses are holding register numbers as passed to
+ * ModbusMaster, i.e. 0-based.
+ */
+
+#ifndef ABBREGISTERS_H_
+#define ABBREGISTERS_H_
+
+#include "ModbusRegister.h"
+
+struct AbbRegisters {
+	typedef Register<0> ControlWord;
+	// reference 1: 20000 = 100 % = 50 Hz; two views of the same register
+	typedef Register<1, uint8_t, Scale<200> > SpeedReference;		// % of full speed
+	typedef Register<1, uint16_t, Scale<400> > FrequencyReference;	// Hz
+	typedef Register<3> StatusWord;
+	typedef Register<4, uint8_t, Scale<200> > SpeedActual;			// %
+
+	// actual values in the units configured on the drive
+	typedef Register<102> OutputFrequency;
+	typedef Register<103> OutputCurrent;
+	typedef RegisterBlock<OutputFrequency, OutputCurrent> Actuals;
+
+	// status word bits
+	static constexpr uint16_t SW_RDY_ON = 0x0001;
+	static constexpr uint16_t SW_RDY_RUN = 0x0002;
+	static constexpr uint16_t SW_RDY_REF = 0x0004;
+	static constexpr uint16_t SW_TRIPPED = 0x0008;
+	static constexpr uint16_t SW_OFF_2_STA = 0x0010;
+	static constexpr uint16_t SW_OFF_3_STA = 0x0020;
+	static constexpr uint16_t SW_SWC_ON_INHIB = 0x0040;
+	static constexpr uint16_t SW_ALARM = 0x0080;
+	static constexpr uint16_t SW_AT_SETPOINT = 0x0100;
+	static constexpr uint16_t SW_REMOTE = 0x0200;
+
+	// control word bits
+	static constexpr uint16_t CW_OFF1_CONTROL = 0x0001;	// 0 = OFF1 (ramp stop)
+	static constexpr uint16_t CW_OFF2_CONTROL = 0x0002;	// 0 = OFF2 (coast stop)
+	static constexpr uint16_t CW_OFF3_CONTROL = 0x0004;	// 0 = OFF3 (emergency stop)
+	static constexpr uint16_t CW_INHIBIT_OPERATION = 0x0008;	// 1 = operation enabled
+	static constexpr uint16_t CW_RAMP_OUT_ZERO = 0x0010;	// 1 = ramp output follows
+	static constexpr uint16_t CW_RAMP_HOLD = 0x0020;		// 1 = ramp runs
+	static constexpr uint16_t CW_RAMP_IN_ZERO = 0x0040;	// 1 = ramp input follows the reference
+	static constexpr uint16_t CW_RESET = 0x0080;			// rising edge resets a fault
+	static constexpr uint16_t CW_REMOTE_CMD = 0x0400;
+
+	// control words used by the startup sequence
+	static constexpr uint16_t CW_STOP = CW_REMOTE_CMD | CW_OFF3_CONTROL | CW_OFF2_CONTROL;		// 0x0406
+	static constexpr uint16_t CW_RUN = CW_STOP | CW_OFF1_CONTROL | CW_INHIBIT_OPERATION |
+			CW_RAMP_OUT_ZERO | CW_RAMP_HOLD | CW_RAMP_IN_ZERO;								// 0x047F
+	static constexpr uint16_t CW_FAULT_RESET = CW_STOP | CW_RESET;							// 0x0486
+};
+
+static_assert(AbbRegisters::CW_STOP == 0x0406 && AbbRegisters::CW_RUN == 0x047F, "ABB Drives profile control words");
+static_assert(AbbRegisters::SpeedReference::encode(100) == 20000, "100 % is 20000");
+static_assert(AbbRegisters::FrequencyReference::encode(50) == 20000, "50 Hz is 20000");
+
+#endif /* ABBREGISTERS_H_ */
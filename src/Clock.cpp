@@ -0,0 +1,58 @@
+/*
+ * Clock.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "Clock.h"
+#include "chip.h"
+
+static uint32_t cyclesPerUs;
+static uint32_t cyclesPerTick;
+static uint32_t usPerTick;
+static volatile uint32_t baseCycles;	// CYCCNT at the latest SysTick reload
+static volatile uint64_t baseUs;
+
+void clockInit() {
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	cyclesPerUs = SystemCoreClock / 1000000;
+	cyclesPerTick = SysTick->LOAD + 1;
+	usPerTick = cyclesPerTick / cyclesPerUs;
+	// SysTick counts down, so LOAD - VAL cycles have passed since its reload
+	baseCycles = DWT->CYCCNT - (SysTick->LOAD - SysTick->VAL);
+	baseUs = 0;
+	__set_PRIMASK(primask);
+}
+
+/* The base moves by the nominal tick length, not by the time the handler
+ * happens to run, so interrupt latency does not leak into the clock.
+ */
+void clockTick() {
+	if(cyclesPerTick == 0) return;
+	baseCycles += cyclesPerTick;
+	baseUs += usPerTick;
+}
+
+/* If the tick is pending while interrupts are masked, the cycle delta just
+ * exceeds one tick and the result is still correct and monotonic.
+ */
+uint64_t micros64() {
+	uint32_t primask = __get_PRIMASK();
+	uint32_t cycles;
+	uint64_t us;
+
+	__disable_irq();
+	cycles = DWT->CYCCNT - baseCycles;
+	us = baseUs;
+	__set_PRIMASK(primask);
+	if(cyclesPerUs == 0) return 0;
+	return us + cycles / cyclesPerUs;
+}
+
+uint32_t micros() {
+	return (uint32_t)micros64();
+}
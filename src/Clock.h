@@ -0,0 +1,41 @@
+/*
+ * Clock.h
+ *
+ *  Created on: 19.10.2026
+ *
+ * Monotonic microsecond clock. The DWT cycle counter gives the resolution
+ * and SysTick, which runs from the same core clock, extends it: every tick
+ * advances a 64-bit base by exactly one tick worth of cycles and
+ * microseconds, so the counter never has to be read across its 60 s wrap.
+ *
+ * micros64() never wraps. micros() wraps after 71 minutes; compare its
+ * values only through the helpers below, which stay correct across the
+ * wrap for intervals shorter than 35 minutes.
+ */
+
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+#include <stdint.h>
+
+void clockInit();		// after SysTick_Config()
+void clockTick();		// from SysTick_Handler
+uint64_t micros64();
+uint32_t micros();
+
+/* microseconds from start to now */
+static inline uint32_t elapsedUs(uint32_t start, uint32_t now) {
+	return now - start;
+}
+
+/* signed distance a - b, negative when a is earlier */
+static inline int32_t timeDiff(uint32_t a, uint32_t b) {
+	return (int32_t)(a - b);
+}
+
+/* true once now has reached deadline */
+static inline bool timeReached(uint32_t now, uint32_t deadline) {
+	return timeDiff(now, deadline) >= 0;
+}
+
+#endif /* CLOCK_H_ */
@@ -0,0 +1,104 @@
+/*
+ * ControlScheduler.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "ControlScheduler.h"
+#include "Clock.h"
+#include <string.h>
+
+static void schedulerTick(void *context) {
+	static_cast<ControlScheduler *>(context)->tick();
+}
+
+/* The step runs in the timer service interrupt, which also serves the
+ * sensor sampler and the LCD. Its priority (TimerService::init) should stay
+ * below (numerically above) the UART and I2C interrupts so that the Modbus
+ * and sensor drivers are never delayed by a control step.
+ */
+ControlScheduler::ControlScheduler(Step step, void *context, uint32_t rateHz) :
+	step(step), context(context), timer(schedulerTick, this), expected(0), lastUs(0), first(true) {
+	if(rateHz < MIN_RATE) rateHz = MIN_RATE;
+	if(rateHz > MAX_RATE) rateHz = MAX_RATE;
+	periodUs = 1000000 / rateHz;
+	cyclesPerUs = SystemCoreClock / 1000000;
+	periodCycles = periodUs * cyclesPerUs;
+	clearStats();
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+ControlScheduler::~ControlScheduler() {
+	stop();
+}
+
+void ControlScheduler::start() {
+	first = true;
+	timer.startPeriodic(periodUs);
+}
+
+void ControlScheduler::stop() {
+	timer.stop();
+}
+
+void ControlScheduler::record(uint32_t *histogram, uint32_t us) {
+	int bucket = 0;
+
+	while(us != 0 && bucket < BUCKETS - 1) {
+		us >>= 1;
+		bucket++;
+	}
+	histogram[bucket]++;
+}
+
+/* Timer interrupt. The ideal time line advances by exactly one period per
+ * tick, so late releases do not accumulate into the next measurement. If a
+ * step overran, the ticks it swallowed are skipped on the time line as well.
+ */
+void ControlScheduler::tick() {
+	uint32_t start = DWT->CYCCNT;
+	uint32_t now = micros();
+	uint32_t dtUs = elapsedUs(lastUs, now);
+	uint32_t jitterUs, execUs;
+	int32_t late;
+
+	if(first) {
+		expected = start;
+		dtUs = periodUs;
+		first = false;
+	}
+	lastUs = now;
+	late = (int32_t)(start - expected);
+	while(late >= (int32_t)periodCycles) {
+		// a tick was lost while the previous step was still running
+		expected += periodCycles;
+		late -= periodCycles;
+	}
+	jitterUs = (late < 0 ? -late : late) / cyclesPerUs;
+	expected += periodCycles;
+
+	step(context, dtUs);
+
+	execUs = (DWT->CYCCNT - start) / cyclesPerUs;
+	stats.ticks++;
+	record((uint32_t *)stats.jitter, jitterUs);
+	record((uint32_t *)stats.exec, execUs);
+	if(jitterUs > stats.maxJitterUs) stats.maxJitterUs = jitterUs;
+	if(execUs > stats.maxExecUs) stats.maxExecUs = execUs;
+	if(DWT->CYCCNT - start >= periodCycles) stats.overruns++;
+}
+
+/* Consistent snapshot: the copy is made with the timer interrupt masked. */
+void ControlScheduler::getStats(Stats &copy) const {
+	NVIC_DisableIRQ(RITIMER_IRQn);
+	memcpy(&copy, (const void *)&stats, sizeof(copy));
+	NVIC_EnableIRQ(RITIMER_IRQn);
+}
+
+void ControlScheduler::clearStats() {
+	NVIC_DisableIRQ(RITIMER_IRQn);
+	memset((void *)&stats, 0, sizeof(stats));
+	NVIC_EnableIRQ(RITIMER_IRQn);
+}
@@ -0,0 +1,63 @@
+/*
+ * ControlScheduler.h
+ *
+ *  Created on: 19.10.2026
+ *
+ * Runs a control step from a periodic software timer at a fixed rate, so the loop
+ * period no longer depends on how long Modbus and the LCD take in the main
+ * loop. Every tick is measured with the DWT cycle counter:
+ *  - release jitter: distance of the interrupt entry from the ideal
+ *    time line (first tick + n * period),
+ *  - execution time of the step,
+ *  - overruns: steps that took longer than a period, so a tick was lost.
+ * Jitter and execution time go into log2 histograms; bucket 0 counts values
+ * below 1 us and bucket i values in [2^(i-1), 2^i) us.
+ */
+
+#ifndef CONTROLSCHEDULER_H_
+#define CONTROLSCHEDULER_H_
+
+#include "chip.h"
+#include "TimerService.h"
+
+class ControlScheduler {
+public:
+	typedef void (*Step)(void *context, uint32_t dtUs);	// dt measured on the Clock
+	static const int BUCKETS = 16;
+
+	struct Stats {
+		uint32_t ticks;
+		uint32_t overruns;
+		uint32_t maxJitterUs;
+		uint32_t maxExecUs;
+		uint32_t jitter[BUCKETS];
+		uint32_t exec[BUCKETS];
+	};
+
+	ControlScheduler(Step step, void *context, uint32_t rateHz = 50);
+	virtual ~ControlScheduler();
+	void start();
+	void stop();
+	uint32_t getPeriodUs() const { return periodUs; }
+	void getStats(Stats &stats) const;
+	void clearStats();
+	void tick();
+private:
+	static void record(uint32_t *histogram, uint32_t us);
+
+	static const uint32_t MIN_RATE = 5;
+	static const uint32_t MAX_RATE = 1000;
+
+	Step step;
+	void *context;
+	SoftTimer timer;
+	uint32_t periodUs;
+	uint32_t periodCycles;
+	uint32_t cyclesPerUs;
+	uint32_t expected;		// CYCCNT of the ideal release of this tick
+	uint32_t lastUs;		// micros() of the previous tick
+	bool first;
+	volatile Stats stats;
+};
+
+#endif /* CONTROLSCHEDULER_H_ */
@@ -0,0 +1,127 @@
+/*
+ * FeedforwardTable.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "FeedforwardTable.h"
+#include "chip.h"
+#include "crc16.h"
+#include <cstddef>
+
+FeedforwardTable::FeedforwardTable() :
+	valid(false), sweeping(false), savePending(false), point(0), pointStart(0), sum(0), count(0) {
+}
+
+uint16_t FeedforwardTable::checksum(const Stored &stored) {
+	const uint8_t *p = (const uint8_t *)&stored;
+	uint16_t crc = 0xFFFF;
+
+	for(unsigned i = 0; i < offsetof(Stored, crc); i++) {
+		crc = crc16_update(crc, p[i]);
+	}
+	return crc;
+}
+
+bool FeedforwardTable::load() {
+	Stored stored;
+
+	valid = false;
+	if(Chip_EEPROM_Read(EEPROM_ADDRESS, (uint8_t *)&stored, sizeof(stored)) != IAP_CMD_SUCCESS) return false;
+	if(stored.magic != MAGIC || stored.crc != checksum(stored)) return false;
+
+	for(int i = 0; i < POINTS; i++) {
+		pressure[i] = Q16::fromRaw(stored.pressure[i]);
+	}
+	valid = true;
+	return true;
+}
+
+bool FeedforwardTable::save() {
+	Stored stored;
+
+	if(!valid) return false;
+	stored.magic = MAGIC;
+	for(int i = 0; i < POINTS; i++) {
+		stored.pressure[i] = pressure[i].toRaw();
+	}
+	stored.crc = checksum(stored);
+	return Chip_EEPROM_Write(EEPROM_ADDRESS, (uint8_t *)&stored, sizeof(stored)) == IAP_CMD_SUCCESS;
+}
+
+/* Inverse lookup: the speed at which the measured curve reaches the given
+ * pressure, interpolated between the two surrounding points and clamped to
+ * the ends of the table.
+ */
+Q16 FeedforwardTable::speedFor(Q16 p) const {
+	if(p <= pressure[0]) return Q16::fromInt(speedAt(0));
+	for(int i = 1; i < POINTS; i++) {
+		if(p <= pressure[i]) {
+			Q16 span = pressure[i] - pressure[i - 1];
+			Q16 s0 = Q16::fromInt(speedAt(i - 1));
+			Q16 s1 = Q16::fromInt(speedAt(i));
+			if(span <= Q16()) return s1;
+			return s0 + (s1 - s0) * ((p - pressure[i - 1]) / span);
+		}
+	}
+	return Q16::fromInt(speedAt(POINTS - 1));
+}
+
+void FeedforwardTable::startSweep(uint32_t nowMs) {
+	sweeping = true;
+	point = 0;
+	pointStart = nowMs;
+	sum = 0;
+	count = 0;
+}
+
+/* Feed the filtered pressure while sweeping; returns the fan speed to
+ * command. Each point waits SETTLE_MS and then averages for AVERAGE_MS.
+ */
+int FeedforwardTable::sweepUpdate(Q16 p, uint32_t nowMs) {
+	if(!sweeping) return 0;
+
+	uint32_t elapsed = nowMs - pointStart;
+	if(elapsed >= SETTLE_MS) {
+		sum += p.toRaw();
+		count++;
+	}
+	if(elapsed >= SETTLE_MS + AVERAGE_MS && count > 0) {
+		swept[point] = Q16::fromRaw((int32_t)(sum / count));
+		sum = 0;
+		count = 0;
+		pointStart = nowMs;
+		if(++point == POINTS) {
+			finish();
+			return 0;
+		}
+	}
+	return speedAt(point);
+}
+
+/* The curve must be monotonic for the inverse lookup; noise at the flat
+ * low end is removed by carrying the running maximum forward.
+ */
+void FeedforwardTable::finish() {
+	sweeping = false;
+	for(int i = 1; i < POINTS; i++) {
+		if(swept[i] < swept[i - 1]) swept[i] = swept[i - 1];
+	}
+	if(swept[POINTS - 1] <= swept[0]) return;	// no usable curve: keep the current table, if any
+
+	for(int i = 0; i < POINTS; i++) {
+		pressure[i] = swept[i];
+	}
+	valid = true;
+	savePending = true;
+}
+
+/* finish() runs in the control step; the EEPROM write goes through IAP
+ * and takes milliseconds, so it is left to the main loop.
+ */
+void FeedforwardTable::poll() {
+	if(savePending) {
+		savePending = false;
+		save();
+	}
+}
@@ -0,0 +1,68 @@
+/*
+ * FeedforwardTable.h
+ *
+ *  Created on: 19.10.2026
+ *
+ * Measured fan speed to pressure characteristic used as PID feedforward.
+ * A sweep steps the fan through POINTS evenly spaced speeds (much like the
+ * fa[] table of the old abbModbusTest()), waits for the pressure to settle
+ * at each one and records the mean filtered pressure. The inverse of that
+ * curve, interpolated linearly, gives the speed expected to hold a desired
+ * pressure, so the PID only has to correct the residual. The table is
+ * kept in the on-chip EEPROM. A sweep records into a separate table that
+ * only replaces the current one when it completes with a usable curve, so
+ * an aborted or failed sweep leaves the feedforward untouched.
+ */
+
+#ifndef FEEDFORWARDTABLE_H_
+#define FEEDFORWARDTABLE_H_
+
+#include <stdint.h>
+#include "FixedPoint.h"
+
+class FeedforwardTable {
+public:
+	static const int POINTS = 11;			// speeds 0, 10, ... 100 %
+
+	FeedforwardTable();
+	bool load();
+	bool save();
+	void poll();			// main loop: saves a finished sweep
+	bool isValid() const { return valid; }
+	Q16 speedFor(Q16 pressure) const;
+	Q16 pressureAt(int point) const { return pressure[point]; }
+	static int speedAt(int point) { return point * 100 / (POINTS - 1); }
+
+	// characterization sweep
+	void startSweep(uint32_t nowMs);
+	int sweepUpdate(Q16 pressure, uint32_t nowMs);
+	void abortSweep() { sweeping = false; }
+	bool isSweeping() const { return sweeping; }
+	int getSweepPoint() const { return point; }
+
+private:
+	struct Stored {
+		uint32_t magic;
+		int32_t pressure[POINTS];	// Q16 raw values
+		uint16_t crc;
+	};
+	void finish();
+	static uint16_t checksum(const Stored &stored);
+
+	static const uint32_t MAGIC = 0x46464231;	// "FFB1"
+	static const uint32_t EEPROM_ADDRESS = 0;
+	static const uint32_t SETTLE_MS = 3000;		// time for the drive and duct to settle
+	static const uint32_t AVERAGE_MS = 1000;	// pressure averaging window
+
+	Q16 pressure[POINTS];
+	Q16 swept[POINTS];		// the sweep in progress
+	bool valid;
+	bool sweeping;
+	volatile bool savePending;
+	int point;
+	uint32_t pointStart;
+	int64_t sum;
+	int32_t count;
+};
+
+#endif /* FEEDFORWARDTABLE_H_ */
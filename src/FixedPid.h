@@ -0,0 +1,58 @@
+/*
+ * FixedPid.h
+ *
+ *  Created on: 19.10.2026
+ *
+ * Fixed-point version of pid() in project.cpp for the FPU-less LPC1549.
+ * Same control law (P + I + D plus linear speed bias, output clamped to
+ * 0..100 %) with gains and state held in Fixed<F>. The float pid() is kept
+ * as the reference; both agree within one output step (see PID_BENCHMARK
+ * in project.cpp).
+ */
+
+#ifndef FIXEDPID_H_
+#define FIXEDPID_H_
+
+#include <stdint.h>
+#include "FixedPoint.h"
+
+template <int F = 16>
+class FixedPid {
+public:
+	typedef Fixed<F> Num;
+
+	FixedPid(Num kp, Num ki, Num kd) : kp(kp), ki(ki), kd(kd), lastError(0) {}
+
+	uint8_t update(uint8_t desired_pressure, uint8_t actual_pressure, uint8_t delta_time) {
+		int32_t error = (signed char)(desired_pressure - actual_pressure);
+		Num speed;
+
+		if(delta_time == 0) delta_time = 1;
+		// bias = desired / 127 * 100, as a single scaled constant
+		speed = Num::fromInt(desired_pressure) * BIAS_SCALE;
+		speed += kp * error;
+		iTerm += ki * (error * delta_time);
+		speed += iTerm;
+		speed += (kd * (error - lastError)) / (int32_t)delta_time;
+		lastError = error;
+
+		if(speed > HUNDRED) speed = HUNDRED;
+		else if(speed < Num()) speed = Num();
+		return speed.toInt();
+	}
+
+	void reset() { iTerm = Num(); lastError = 0; }
+
+private:
+	static constexpr Num BIAS_SCALE = Num::fromFloat(100.0f / 127.0f);
+	static constexpr Num HUNDRED = Num::fromInt(100);
+
+	Num kp, ki, kd;
+	Num iTerm;
+	int32_t lastError;
+};
+
+template <int F> constexpr typename FixedPid<F>::Num FixedPid<F>::BIAS_SCALE;
+template <int F> constexpr typename FixedPid<F>::Num FixedPid<F>::HUNDRED;
+
+#endif /* FIXEDPID_H_ */
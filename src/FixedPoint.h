@@ -0,0 +1,77 @@
+/*
+ * FixedPoint.h
+ *
+ *  Created on: 19.10.2026
+ *
+ * Signed 32-bit fixed-point number with F fractional bits (Fixed<16> is
+ * Q15.16). All arithmetic saturates at the range limits instead of wrapping.
+ * The LPC1549 has no FPU, so this replaces soft-float in the control path;
+ * fromFloat() is meant for compile-time constants only.
+ */
+
+#ifndef FIXEDPOINT_H_
+#define FIXEDPOINT_H_
+
+#include <stdint.h>
+
+template <int F>
+class Fixed {
+	static_assert(F > 0 && F < 31, "Fixed needs 1..30 fractional bits");
+public:
+	static const int FRAC_BITS = F;
+
+	constexpr Fixed() : raw(0) {}
+
+	static constexpr Fixed fromRaw(int32_t r) { return Fixed(r, 0); }
+	static constexpr Fixed fromInt(int32_t v) { return Fixed(saturate((int64_t)v * (1LL << F)), 0); }
+	static constexpr Fixed fromFloat(float v) {
+		return Fixed(saturate((int64_t)(v * (float)(1LL << F) + (v < 0 ? -0.5f : 0.5f))), 0);
+	}
+	static constexpr Fixed max() { return Fixed(INT32_MAX, 0); }
+	static constexpr Fixed min() { return Fixed(INT32_MIN, 0); }
+
+	constexpr int32_t toRaw() const { return raw; }
+	constexpr int32_t toInt() const { return raw >> F; }				// rounds towards -inf
+	constexpr int32_t round() const { return (int32_t)(((int64_t)raw + (1LL << (F - 1))) >> F); }
+	float toFloat() const { return (float)raw / (float)(1LL << F); }
+
+	Fixed operator+(Fixed o) const { return Fixed(saturate((int64_t)raw + o.raw), 0); }
+	Fixed operator-(Fixed o) const { return Fixed(saturate((int64_t)raw - o.raw), 0); }
+	Fixed operator-() const { return Fixed(saturate(-(int64_t)raw), 0); }
+	Fixed operator*(Fixed o) const {
+		return Fixed(saturate(((int64_t)raw * o.raw + (1LL << (F - 1))) >> F), 0);
+	}
+	/* 64/32-bit division; avoid in hot paths where a multiply will do */
+	Fixed operator/(Fixed o) const {
+		if(o.raw == 0) return raw < 0 ? min() : max();
+		return Fixed(saturate((int64_t)raw * (1LL << F) / o.raw), 0);
+	}
+	Fixed operator*(int32_t v) const { return Fixed(saturate((int64_t)raw * v), 0); }
+	Fixed operator/(int32_t v) const {
+		if(v == 0) return raw < 0 ? min() : max();
+		return Fixed(raw / v, 0);
+	}
+
+	Fixed &operator+=(Fixed o) { return *this = *this + o; }
+	Fixed &operator-=(Fixed o) { return *this = *this - o; }
+	Fixed &operator*=(Fixed o) { return *this = *this * o; }
+
+	bool operator<(Fixed o) const { return raw < o.raw; }
+	bool operator>(Fixed o) const { return raw > o.raw; }
+	bool operator<=(Fixed o) const { return raw <= o.raw; }
+	bool operator>=(Fixed o) const { return raw >= o.raw; }
+	bool operator==(Fixed o) const { return raw == o.raw; }
+	bool operator!=(Fixed o) const { return raw != o.raw; }
+
+private:
+	constexpr Fixed(int32_t r, int) : raw(r) {}
+	static constexpr int32_t saturate(int64_t v) {
+		return v > INT32_MAX ? INT32_MAX : (v < INT32_MIN ? INT32_MIN : (int32_t)v);
+	}
+
+	int32_t raw;
+};
+
+typedef Fixed<16> Q16;
+
+#endif /* FIXEDPOINT_H_ */
@@ -0,0 +1,97 @@
+/*
+ * Format.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "Format.h"
+
+static const uint32_t POW10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+static const uint8_t MAX_DECIMALS = 6;
+
+/* Digits of value, least significant first; returns their number. */
+static int reverseDigits(char *tmp, uint32_t value, int minDigits) {
+	int n = 0;
+
+	do {
+		tmp[n++] = '0' + value % 10;
+		value /= 10;
+	} while(value != 0 || n < minDigits);
+	return n;
+}
+
+/* Copy sign, padding and the reversed digits into buf. A zero pad goes
+ * between the sign and the digits, a space pad before the sign.
+ */
+static int emit(char *buf, size_t size, bool negative, const char *tmp, int n, uint8_t width, char pad) {
+	int total = n + (negative ? 1 : 0);
+	size_t len = 0;
+
+	if(size == 0) return 0;
+	if(negative && pad == '0' && len < size - 1) buf[len++] = '-';
+	for(int i = total; i < width && len < size - 1; i++) buf[len++] = pad;
+	if(negative && pad != '0' && len < size - 1) buf[len++] = '-';
+	while(n > 0 && len < size - 1) buf[len++] = tmp[--n];
+	buf[len] = '\0';
+	return len;
+}
+
+int formatUnsigned(char *buf, size_t size, uint32_t value, uint8_t width, char pad) {
+	char tmp[10];
+
+	return emit(buf, size, false, tmp, reverseDigits(tmp, value, 1), width, pad);
+}
+
+int formatDec(char *buf, size_t size, int32_t value, uint8_t width, char pad) {
+	char tmp[10];
+	// negate in unsigned arithmetic so that INT32_MIN works too
+	uint32_t magnitude = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+
+	return emit(buf, size, value < 0, tmp, reverseDigits(tmp, magnitude, 1), width, pad);
+}
+
+int formatHex(char *buf, size_t size, uint32_t value, uint8_t digits) {
+	static const char HEX[] = "0123456789ABCDEF";
+	char tmp[8];
+	int n = 0;
+
+	if(digits > sizeof(tmp)) digits = sizeof(tmp);
+	do {
+		tmp[n++] = HEX[value & 0xF];
+		value >>= 4;
+	} while(value != 0 || n < digits);
+	return emit(buf, size, false, tmp, n, 0, ' ');
+}
+
+/* Integer and fraction are formatted separately, so the only wide
+ * operation is a 32x32->64 bit multiply; there is no 64-bit division.
+ * fracBits is clamped to 0..31 so that no shift is out of range.
+ */
+int formatFixed(char *buf, size_t size, int32_t raw, int fracBits, uint8_t decimals, uint8_t width) {
+	char tmp[10 + 1 + MAX_DECIMALS];
+	uint32_t magnitude = raw < 0 ? 0u - (uint32_t)raw : (uint32_t)raw;
+	uint32_t integer, fraction;
+	int n = 0;
+
+	if(fracBits < 0) fracBits = 0;
+	if(fracBits > 31) fracBits = 31;
+	if(decimals > MAX_DECIMALS) decimals = MAX_DECIMALS;
+	integer = magnitude >> fracBits;
+	fraction = magnitude & ((1UL << fracBits) - 1);
+	if(fracBits > 0) {
+		// an integer (fracBits 0) has no fraction and nothing to round
+		fraction = (uint32_t)(((uint64_t)fraction * POW10[decimals] + (1UL << (fracBits - 1))) >> fracBits);
+	}
+	if(fraction >= POW10[decimals]) {
+		// rounding carried into the integer part
+		fraction -= POW10[decimals];
+		integer++;
+	}
+	if(decimals > 0) {
+		n = reverseDigits(tmp, fraction, decimals);
+		tmp[n++] = '.';
+	}
+	n += reverseDigits(tmp + n, integer, 1);
+	// no sign on a value that rounds to zero
+	return emit(buf, size, raw < 0 && (integer != 0 || fraction != 0), tmp, n, width, ' ');
+}
@@ -0,0 +1,81 @@
+/*
+ * Format.h
+ *
+ *  Created on: 19.10.2026
+ *
+ * Number formatting into caller-provided buffers, as a replacement for
+ * std::to_string() and snprintf() in the main loop. Nothing here allocates
+ * or touches libstdc++. Every function writes a terminated string of at
+ * most size - 1 characters, truncating the output when the buffer is too
+ * small, and returns the number of characters written.
+ *
+ * TextBuffer<N> collects a line in a fixed array on the stack:
+ *     TextBuffer<16> line;
+ *     line.str("Desire: ").dec(desired, 3);
+ *     lcd.framePrint(line.c_str());
+ */
+
+#ifndef FORMAT_H_
+#define FORMAT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "FixedPoint.h"
+
+/* width pads on the left with pad; a value wider than width is not cut */
+int formatDec(char *buf, size_t size, int32_t value, uint8_t width = 0, char pad = ' ');
+int formatUnsigned(char *buf, size_t size, uint32_t value, uint8_t width = 0, char pad = ' ');
+/* upper case, at least digits digits with leading zeros */
+int formatHex(char *buf, size_t size, uint32_t value, uint8_t digits = 0);
+/* raw fixed-point value with fracBits (0..31) fractional bits, rounded to
+ * decimals (0..6) places */
+int formatFixed(char *buf, size_t size, int32_t raw, int fracBits, uint8_t decimals, uint8_t width = 0);
+
+template <int F>
+inline int formatFixed(char *buf, size_t size, Fixed<F> value, uint8_t decimals, uint8_t width = 0) {
+	return formatFixed(buf, size, value.toRaw(), F, decimals, width);
+}
+
+template <size_t N>
+class TextBuffer {
+	static_assert(N > 1, "TextBuffer needs room for the terminator");
+public:
+	TextBuffer() : len(0) { buf[0] = '\0'; }
+
+	TextBuffer &clear() { len = 0; buf[0] = '\0'; return *this; }
+	TextBuffer &str(const char *s) {
+		while(*s != '\0' && len < N - 1) buf[len++] = *s++;
+		buf[len] = '\0';
+		return *this;
+	}
+	TextBuffer &ch(char c) {
+		if(len < N - 1) buf[len++] = c;
+		buf[len] = '\0';
+		return *this;
+	}
+	TextBuffer &dec(int32_t value, uint8_t width = 0, char pad = ' ') {
+		len += formatDec(buf + len, N - len, value, width, pad);
+		return *this;
+	}
+	TextBuffer &udec(uint32_t value, uint8_t width = 0, char pad = ' ') {
+		len += formatUnsigned(buf + len, N - len, value, width, pad);
+		return *this;
+	}
+	TextBuffer &hex(uint32_t value, uint8_t digits = 0) {
+		len += formatHex(buf + len, N - len, value, digits);
+		return *this;
+	}
+	template <int F>
+	TextBuffer &fixed(Fixed<F> value, uint8_t decimals, uint8_t width = 0) {
+		len += formatFixed(buf + len, N - len, value.toRaw(), F, decimals, width);
+		return *this;
+	}
+
+	const char *c_str() const { return buf; }
+	size_t length() const { return len; }
+private:
+	char buf[N];
+	size_t len;
+};
+
+#endif /* FORMAT_H_ */
@@ -0,0 +1,158 @@
+/*
+ * Heap.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "Heap.h"
+#include <stdlib.h>
+#include "chip.h"
+#include "SerialPort.h"
+#include "RtuFrameAssembler.h"
+
+/* A pool recycles released blocks through a free list threaded through
+ * them and carves never-used blocks off its storage only when that is empty.
+ * Everything is zero or constant initialized, so operator new works even
+ * from constructors of global objects.
+ */
+struct Pool {
+	uint8_t *storage;
+	uint16_t size;			// multiple of 8, the EABI alignment of new
+	uint16_t blocks;
+	uint16_t carved;		// blocks handed out at least once
+	uint16_t used;
+	uint16_t peak;
+	void *freeList;
+};
+
+/* Size classes of this application: the serial port and the RTU frame
+ * assembler that ModbusMaster creates in begin(), plus room for small
+ * objects. */
+static const uint16_t SERIAL_PORT_BLOCK = 384;
+static const uint16_t ASSEMBLER_BLOCK = 640;
+static_assert(sizeof(SerialPort) <= SERIAL_PORT_BLOCK, "SerialPort no longer fits its size class");
+static_assert(sizeof(RtuFrameAssembler) <= ASSEMBLER_BLOCK, "RtuFrameAssembler no longer fits its size class");
+
+static uint8_t storage32[16 * 32] __attribute__((aligned(8)));
+static uint8_t storage64[8 * 64] __attribute__((aligned(8)));
+static uint8_t storage128[4 * 128] __attribute__((aligned(8)));
+static uint8_t storageSerial[2 * SERIAL_PORT_BLOCK] __attribute__((aligned(8)));
+static uint8_t storageAssembler[2 * ASSEMBLER_BLOCK] __attribute__((aligned(8)));
+
+static Pool pools[HEAP_CLASSES] = {
+	{ storage32, 32, 16, 0, 0, 0, NULL },
+	{ storage64, 64, 8, 0, 0, 0, NULL },
+	{ storage128, 128, 4, 0, 0, 0, NULL },
+	{ storageSerial, SERIAL_PORT_BLOCK, 2, 0, 0, 0, NULL },
+	{ storageAssembler, ASSEMBLER_BLOCK, 2, 0, 0, 0, NULL },
+};
+
+static volatile uint32_t allocations = 0;
+static uint32_t frees = 0;
+static uint32_t failures = 0;
+static uint32_t lateAllocations = 0;
+static uint32_t bytesInUse = 0;
+static uint32_t bytesPeak = 0;
+static bool sealed = false;
+
+/* new and delete may be used from interrupts as well */
+static inline uint32_t enterCritical() {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	return primask;
+}
+
+static inline void exitCritical(uint32_t primask) {
+	__set_PRIMASK(primask);
+}
+
+static void *take(Pool &pool) {
+	void *block;
+
+	if(pool.freeList != NULL) {
+		block = pool.freeList;
+		pool.freeList = *static_cast<void **>(block);
+	}
+	else if(pool.carved < pool.blocks) {
+		block = pool.storage + pool.carved++ * pool.size;
+	}
+	else {
+		return NULL;
+	}
+	if(++pool.used > pool.peak) pool.peak = pool.used;
+	bytesInUse += pool.size;
+	if(bytesInUse > bytesPeak) bytesPeak = bytesInUse;
+	return block;
+}
+
+void *heapAllocate(size_t size) {
+	void *block = NULL;
+	uint32_t primask;
+
+	if(size == 0) size = 1;
+
+	primask = enterCritical();
+	allocations++;
+	if(sealed) {
+		lateAllocations++;
+#if HEAP_TRAP
+		__BKPT(0);	// halts under a debugger, hard faults without one
+#endif
+	}
+	for(int i = 0; i < HEAP_CLASSES && block == NULL; i++) {
+		if(size <= pools[i].size) block = take(pools[i]);
+	}
+	if(block == NULL) failures++;
+	exitCritical(primask);
+
+	if(block == NULL) block = malloc(size);
+	return block;
+}
+
+void heapFree(void *p) {
+	uint8_t *block = static_cast<uint8_t *>(p);
+	uint32_t primask;
+
+	if(p == NULL) return;
+	primask = enterCritical();
+	frees++;
+	for(int i = 0; i < HEAP_CLASSES; i++) {
+		Pool &pool = pools[i];
+		if(block >= pool.storage && block < pool.storage + pool.blocks * pool.size) {
+			*static_cast<void **>(p) = pool.freeList;
+			pool.freeList = p;
+			pool.used--;
+			bytesInUse -= pool.size;
+			exitCritical(primask);
+			return;
+		}
+	}
+	exitCritical(primask);
+	free(p);
+}
+
+void heapSeal() {
+	sealed = true;
+}
+
+void heapGetStats(HeapStats &stats) {
+	uint32_t primask = enterCritical();
+
+	stats.allocations = allocations;
+	stats.frees = frees;
+	stats.failures = failures;
+	stats.lateAllocations = lateAllocations;
+	stats.bytesInUse = bytesInUse;
+	stats.bytesPeak = bytesPeak;
+	for(int i = 0; i < HEAP_CLASSES; i++) {
+		stats.classSize[i] = pools[i].size;
+		stats.classBlocks[i] = pools[i].blocks;
+		stats.classUsed[i] = pools[i].used;
+		stats.classPeak[i] = pools[i].peak;
+	}
+	exitCritical(primask);
+}
+
+uint32_t heapAllocationCount() {
+	return allocations;
+}
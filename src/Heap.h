@@ -0,0 +1,52 @@
+/*
+ * Heap.h
+ *
+ *  Created on: 19.10.2026
+ *
+ * operator new and delete (cr_cpp_config.cpp) are served from fixed-block
+ * pools instead of malloc, so objects created and destroyed at run time
+ * cannot fragment the small LPC1549 heap. A request goes to the smallest
+ * size class with a free block; only when none is left, or the request is
+ * larger than the largest class, does it fall back to malloc, and that is
+ * counted as a failure. The classes are sized for this application in
+ * Heap.cpp; use the per-class peaks to resize them.
+ *
+ * The main loop is meant to run without allocations. Call heapSeal() when
+ * initialization is done: later allocations are counted and, with
+ * HEAP_TRAP set to 1 (here or with -DHEAP_TRAP=1), stop at a breakpoint.
+ */
+
+#ifndef HEAP_H_
+#define HEAP_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef HEAP_TRAP
+#define HEAP_TRAP 0
+#endif
+
+static const int HEAP_CLASSES = 5;
+
+struct HeapStats {
+	uint32_t allocations;		// calls of operator new and new[]
+	uint32_t frees;
+	uint32_t failures;			// served by malloc instead of a pool
+	uint32_t lateAllocations;	// after heapSeal()
+	uint32_t bytesInUse;		// pool blocks, in whole blocks
+	uint32_t bytesPeak;
+	uint16_t classSize[HEAP_CLASSES];
+	uint16_t classBlocks[HEAP_CLASSES];
+	uint16_t classUsed[HEAP_CLASSES];
+	uint16_t classPeak[HEAP_CLASSES];
+};
+
+void *heapAllocate(size_t size);
+void heapFree(void *p);
+void heapSeal();
+void heapGetStats(HeapStats &stats);
+
+/* calls of operator new and new[] since reset, including from libstdc++ */
+uint32_t heapAllocationCount();
+
+#endif /* HEAP_H_ */
@@ -39,14 +39,34 @@
 
 #include "I2C.h"
 
+/* provided by the application, see ModbusMaster.h */
+uint32_t millis();
 
-I2C::I2C(int deviceNumber, uint32_t speed) {
+/* the interrupt handler needs to find the object; only I2C0 is supported */
+static I2C *i2c0 = NULL;
+
+extern "C" {
+/**
+ * @brief	I2C0 interrupt handler, drives the queued transfers
+ * @return	Nothing
+ */
+void I2C0_IRQHandler(void)
+{
+	if(i2c0 != NULL) i2c0->isr();
+}
+}
+
+
+I2C::I2C(int deviceNumber, uint32_t speed) :
+	head(0), tail(0), active(false), startTime(0), timeoutMs(DEFAULT_TIMEOUT_MS), timeouts(0) {
 	if(deviceNumber == 0) {
 		device = LPC_I2C0;
+		irq = I2C0_IRQn;
 		Chip_IOCON_PinMuxSet(LPC_IOCON, 0, 22, IOCON_DIGMODE_EN | I2C_MODE);
 		Chip_IOCON_PinMuxSet(LPC_IOCON, 0, 23, IOCON_DIGMODE_EN | I2C_MODE);
 		Chip_SWM_EnableFixedPin(SWM_FIXED_I2C0_SCL);
 		Chip_SWM_EnableFixedPin(SWM_FIXED_I2C0_SDA);
+		i2c0 = this;
 	}
 	else {
 		// currently we support only I2C number 0
@@ -63,37 +83,138 @@ I2C::I2C(int deviceNumber, uint32_t speed) {
 
 	/* Enable Master Mode */
 	Chip_I2CM_Enable(device);
+
+	/* Master interrupts are enabled only while requests are queued */
+	Chip_I2C_DisableInt(device, MASTER_INTS);
+	NVIC_EnableIRQ(irq);
 }
 
 I2C::~I2C() {
-	// TODO Auto-generated destructor stub
+	NVIC_DisableIRQ(irq);
+	Chip_I2C_DisableInt(device, MASTER_INTS);
+	if(i2c0 == this) i2c0 = NULL;
 }
 
 
+static void signalDone(void *context, uint16_t status) {
+	*(volatile uint16_t *)context = status;
+}
+
+/* Blocking transfer built on the queue. The CPU sleeps until the transfer
+ * completes instead of spinning on the master state.
+ */
 bool I2C::transaction(uint8_t devAddr, uint8_t *txBuffPtr, uint16_t txSize, uint8_t *rxBuffPtr, uint16_t rxSize) {
-	I2CM_XFER_T  i2cmXferRec;
+	volatile uint16_t status = I2CM_STATUS_BUSY;
 
-	// make sure that master is idle
-	while(!Chip_I2CM_IsMasterPending(device));
+	if(!submit(devAddr, txBuffPtr, txSize, rxBuffPtr, rxSize, signalDone, (void *)&status)) {
+		return false;
+	}
+	while(status == I2CM_STATUS_BUSY) {
+		poll();
+		__WFI();
+	}
 
-	/* Setup I2C transfer record */
-	i2cmXferRec.slaveAddr = devAddr;
-	i2cmXferRec.status = 0;
-	i2cmXferRec.txSz = txSize;
-	i2cmXferRec.rxSz = rxSize;
-	i2cmXferRec.txBuff = txBuffPtr;
-	i2cmXferRec.rxBuff = rxBuffPtr;
+	/* Test for valid operation */
+	return status == I2CM_STATUS_OK;
+}
 
-	Chip_I2CM_XferBlocking(device, &i2cmXferRec);
-	// Chip_I2CM_XferBlocking returns before stop condition is fully completed 
-	// therefore we need to wait for master to be idle when doing back-to-back transactions
+/* Queue a transfer and return immediately. The callback is called from
+ * interrupt context when the transfer completes, fails or times out; the
+ * buffers must stay valid until then. Returns false if the queue is full.
+ * May be called from interrupt handlers.
+ */
+bool I2C::submit(uint8_t devAddr, const uint8_t *txBuffPtr, uint16_t txSize, uint8_t *rxBuffPtr, uint16_t rxSize,
+		Callback callback, void *context) {
+	bool queued;
+	uint32_t primask = __get_PRIMASK();
 
-	/* Test for valid operation */
-	if (i2cmXferRec.status == I2CM_STATUS_OK) {
-		return true;
+	__disable_irq();
+	queued = (uint8_t)(head - tail) < QUEUE_SIZE;
+	if(queued) {
+		Request &r = queue[head & (QUEUE_SIZE - 1)];
+		r.devAddr = devAddr;
+		r.txBuff = txBuffPtr;
+		r.txSize = txSize;
+		r.rxBuff = rxBuffPtr;
+		r.rxSize = rxSize;
+		r.callback = callback;
+		r.context = context;
+		head++;
+		// an idle master raises MSTPENDING immediately, which starts the transfer
+		Chip_I2C_EnableInt(device, MASTER_INTS);
 	}
-	else {
-		return false;
+	__set_PRIMASK(primask);
+
+	return queued;
+}
+
+/* Timeout supervision: call periodically from the main loop or a timer.
+ * A transfer that has not completed in time is aborted and the master is
+ * restarted so that a stuck bus cannot block the queue forever.
+ */
+void I2C::poll() {
+	NVIC_DisableIRQ(irq);
+	if(active && (millis() - startTime) > timeoutMs) {
+		timeouts++;
+		Chip_I2CM_SendStop(device);
+		Chip_I2CM_Disable(device);
+		Chip_I2CM_Enable(device);
+		finish(TIMEOUT);
 	}
+	NVIC_EnableIRQ(irq);
+}
+
+bool I2C::isIdle() {
+	return !active && head == tail;
 }
 
+void I2C::isr() {
+	uint32_t state = Chip_I2C_GetPendingInt(device);
+
+	/* Error handling */
+	if(state & (I2C_INTSTAT_MSTRARBLOSS | I2C_INTSTAT_MSTSTSTPERR)) {
+		Chip_I2CM_ClearStatus(device, I2C_STAT_MSTRARBLOSS | I2C_STAT_MSTSTSTPERR);
+		if(active) finish((state & I2C_INTSTAT_MSTRARBLOSS) ? I2CM_STATUS_ARBLOST : I2CM_STATUS_BUS_ERROR);
+	}
+	else if(state & I2C_INTSTAT_MSTPENDING) {
+		if(active) {
+			Chip_I2CM_XferHandler(device, &xfer);
+			if(xfer.status != I2CM_STATUS_BUSY) finish(xfer.status);
+		}
+		else {
+			// master is idle (stop condition completed): start the next request
+			startNext();
+		}
+	}
+}
+
+void I2C::startNext() {
+	if(head == tail) {
+		Chip_I2C_DisableInt(device, MASTER_INTS);
+		return;
+	}
+
+	/* Setup I2C transfer record */
+	Request &r = queue[tail & (QUEUE_SIZE - 1)];
+	xfer.slaveAddr = r.devAddr;
+	xfer.status = 0;
+	xfer.txSz = r.txSize;
+	xfer.rxSz = r.rxSize;
+	xfer.txBuff = r.txBuff;
+	xfer.rxBuff = r.rxBuff;
+
+	active = true;
+	startTime = millis();
+	Chip_I2CM_Xfer(device, &xfer);
+}
+
+void I2C::finish(uint16_t status) {
+	Request &r = queue[tail & (QUEUE_SIZE - 1)];
+	Callback callback = r.callback;
+	void *context = r.context;
+
+	active = false;
+	tail++;
+	if(callback != NULL) callback(context, status);
+	// MSTPENDING fires again once the master is idle and starts the next request
+}
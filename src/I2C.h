@@ -12,13 +12,51 @@
 
 class I2C {
 public:
+	/* Completion callback, called from the I2C interrupt with the transfer
+	 * status (I2CM_STATUS_OK, one of the I2CM_STATUS_* errors or TIMEOUT) */
+	typedef void (*Callback)(void *context, uint16_t status);
+	static const uint16_t TIMEOUT = 0x10;
+	static const uint32_t DEFAULT_TIMEOUT_MS = 50;
+
 	I2C(int deviceNumber, uint32_t speed);
 	virtual ~I2C();
 	bool transaction(uint8_t devAddr, uint8_t *txBuffPtr, uint16_t txSize, uint8_t *rxBuffPtr, uint16_t rxSize);
+	bool submit(uint8_t devAddr, const uint8_t *txBuffPtr, uint16_t txSize, uint8_t *rxBuffPtr, uint16_t rxSize,
+			Callback callback, void *context);
+	void poll();
+	bool isIdle();
+	void setTimeout(uint32_t ms) { timeoutMs = ms; }
+	uint32_t getTimeout() const { return timeoutMs; }
+	uint32_t getTimeouts() const { return timeouts; }
+	void isr();
 private:
+	struct Request {
+		uint8_t devAddr;
+		const uint8_t *txBuff;
+		uint16_t txSize;
+		uint8_t *rxBuff;
+		uint16_t rxSize;
+		Callback callback;
+		void *context;
+	};
+	void startNext();
+	void finish(uint16_t status);
+
 	LPC_I2C_T *device;
+	IRQn_Type irq;
 	static const unsigned int I2C_CLK_DIVIDER = 40;
 	static const unsigned int I2C_MODE = 0;
+	static const uint8_t QUEUE_SIZE = 4;	// must be a power of two
+	static const uint32_t MASTER_INTS = I2C_INTENSET_MSTPENDING | I2C_INTENSET_MSTRARBLOSS | I2C_INTENSET_MSTSTSTPERR;
+
+	Request queue[QUEUE_SIZE];
+	volatile uint8_t head;
+	volatile uint8_t tail;
+	volatile bool active;		// queue[tail] is on the bus
+	I2CM_XFER_T xfer;
+	volatile uint32_t startTime;
+	uint32_t timeoutMs;
+	volatile uint32_t timeouts;
 };
 
 #endif /* I2C_H_ */
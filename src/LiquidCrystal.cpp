@@ -2,28 +2,13 @@
 
 #include <cstring>
 #include "chip.h"
-#include "ritimer_15xx.h"
+#include "Profiler.h"
+#include "Format.h"
 
 #define LOW 0
 #define HIGH 1
 
 
-
-void delayMicroseconds(unsigned int us)
-{
-//	uint32_t SysTickRate = Chip_Clock_GetSysTickClockRate();
-//	uint64_t comval = SysTickRate/1000000*us;
-	uint64_t comval = 72*us;
-	Chip_RIT_Disable(LPC_RITIMER);
-	Chip_RIT_SetCompareValue(LPC_RITIMER, comval);
-	Chip_RIT_SetCounter(LPC_RITIMER, 0);
-	Chip_RIT_Enable(LPC_RITIMER);
-	while(!Chip_RIT_GetIntStatus(LPC_RITIMER)) {
-	}
-	Chip_RIT_Disable(LPC_RITIMER);
-	Chip_RIT_ClearIntStatus(LPC_RITIMER);
-}
-
 // When the display powers up, it is configured as follows:
 //
 // 1. Display clear
@@ -46,8 +31,14 @@ void delayMicroseconds(unsigned int us)
 
 
 
+static void lcdTick(void *context)
+{
+  static_cast<LiquidCrystal *>(context)->tick();
+}
+
 LiquidCrystal::LiquidCrystal(DigitalIoPin *rs,  DigitalIoPin *enable,
-			     DigitalIoPin *d0, DigitalIoPin *d1, DigitalIoPin *d2, DigitalIoPin *d3)
+			     DigitalIoPin *d0, DigitalIoPin *d1, DigitalIoPin *d2, DigitalIoPin *d3) :
+  _timer(lcdTick, this)
 {
   rs_pin = rs;
   enable_pin = enable;
@@ -59,6 +50,12 @@ LiquidCrystal::LiquidCrystal(DigitalIoPin *rs,  DigitalIoPin *enable,
 
   _displayfunction = LCD_4BITMODE | LCD_1LINE | LCD_5x8DOTS;
 
+  // the enable pulse (> 450 ns) is timed on the cycle counter
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  _enableCycles = SystemCoreClock / 1000000;
+  _busy = false;
+
   begin(16, 2); // default to 16x2 display
 }
 
@@ -66,7 +63,8 @@ void LiquidCrystal::begin(uint8_t cols, uint8_t lines, uint8_t dotsize) {
   if (lines > 1) {
     _displayfunction |= LCD_2LINE;
   }
-  _numlines = lines;
+  _numlines = lines > MAX_ROWS ? MAX_ROWS : lines;
+  _numcols = cols > MAX_COLS ? MAX_COLS : cols;
   _currline = 0;
 
   // for some 1 line displays you can select a 10 pixel high font
@@ -74,14 +72,17 @@ void LiquidCrystal::begin(uint8_t cols, uint8_t lines, uint8_t dotsize) {
     _displayfunction |= LCD_5x10DOTS;
   }
 
-  // SEE PAGE 45/46 FOR INITIALIZATION SPECIFICATION!
-  // according to datasheet, we need at least 40ms after power rises above 2.7V
-  // before sending commands. Arduino can turn on way befer 4.5V so we'll wait 50
-  delayMicroseconds(50000);
+  // the pins are driven directly below, so nothing may still be queued
+  waitIdle();
   // Now we pull both RS and R/W low to begin commands
   rs_pin->Write(false); //digitalWrite(_rs_pin, LOW);
   enable_pin->Write(false); //digitalWrite(_enable_pin, LOW);
 
+  // SEE PAGE 45/46 FOR INITIALIZATION SPECIFICATION!
+  // according to datasheet, we need at least 40ms after power rises above 2.7V
+  // before sending commands. Arduino can turn on way befer 4.5V so we'll wait 50
+  enqueue(0, OP_WAIT, 50000);
+
   // note: this port supports only 4 bit mode
   //put the LCD into 4 bit or 8 bit mode
   if (! (_displayfunction & LCD_8BITMODE)) {
@@ -89,30 +90,25 @@ void LiquidCrystal::begin(uint8_t cols, uint8_t lines, uint8_t dotsize) {
     // figure 24, pg 46
 
     // we start in 8bit mode, try to set 4 bit mode
-    write4bits(0x03);
-    delayMicroseconds(4500); // wait min 4.1ms
+    enqueue(0x03, OP_NIBBLE, 4500); // wait min 4.1ms
 
     // second try
-    write4bits(0x03);
-    delayMicroseconds(4500); // wait min 4.1ms
+    enqueue(0x03, OP_NIBBLE, 4500); // wait min 4.1ms
 
     // third go!
-    write4bits(0x03);
-    delayMicroseconds(150);
+    enqueue(0x03, OP_NIBBLE, 150);
 
     // finally, set to 4-bit interface
-    write4bits(0x02);
+    enqueue(0x02, OP_NIBBLE, EXEC_US);
   } else {
     // this is according to the hitachi HD44780 datasheet
     // page 45 figure 23
 
     // Send function set command sequence
-    command(LCD_FUNCTIONSET | _displayfunction);
-    delayMicroseconds(4500);  // wait more than 4.1ms
+    enqueue(LCD_FUNCTIONSET | _displayfunction, 0, 4500);  // wait more than 4.1ms
 
     // second try
-    command(LCD_FUNCTIONSET | _displayfunction);
-    delayMicroseconds(150);
+    enqueue(LCD_FUNCTIONSET | _displayfunction, 0, 150);
 
     // third go
     command(LCD_FUNCTIONSET | _displayfunction);
@@ -133,19 +129,19 @@ void LiquidCrystal::begin(uint8_t cols, uint8_t lines, uint8_t dotsize) {
   // set the entry mode
   command(LCD_ENTRYMODESET | _displaymode);
 
+  frameClear();
 }
 
 /********** high level commands, for the user! */
 void LiquidCrystal::clear()
 {
-  command(LCD_CLEARDISPLAY);  // clear display, set cursor position to zero
-  delayMicroseconds(2000);  // this command takes a long time!
+  enqueue(LCD_CLEARDISPLAY, 0, 2000);  // clear display, set cursor position to zero; takes a long time!
+  memset(_shown, ' ', sizeof(_shown));
 }
 
 void LiquidCrystal::home()
 {
-  command(LCD_RETURNHOME);  // set cursor position to zero
-  delayMicroseconds(2000);  // this command takes a long time!
+  enqueue(LCD_RETURNHOME, 0, 2000);  // set cursor position to zero; takes a long time!
 }
 
 
@@ -156,11 +152,104 @@ void LiquidCrystal::print(std::string const &s)
 
 void LiquidCrystal::print(const char *s)
 {
+	PROFILE_ZONE(PROFILE_LCD_PRINT);
 	for(const char *i = s; *i != '\0'; i++) {
 		this->write(*i);
 	}
 }
 
+void LiquidCrystal::print(int value, uint8_t width)
+{
+  char text[12];
+  formatDec(text, sizeof(text), value, width);
+  print(text);
+}
+
+void LiquidCrystal::print(Q16 value, uint8_t decimals, uint8_t width)
+{
+  char text[20];
+  formatFixed(text, sizeof(text), value, decimals, width);
+  print(text);
+}
+
+/********** frame buffer */
+
+void LiquidCrystal::frameClear()
+{
+  memset(_frame, ' ', sizeof(_frame));
+  _frameCol = 0;
+  _frameRow = 0;
+}
+
+void LiquidCrystal::frameSetCursor(uint8_t col, uint8_t row)
+{
+  _frameCol = col;
+  _frameRow = row < _numlines ? row : _numlines - 1;
+}
+
+void LiquidCrystal::framePrint(std::string const &s)
+{
+  framePrint(s.c_str());
+}
+
+// text beyond the end of the line is dropped, it does not wrap
+void LiquidCrystal::framePrint(const char *s)
+{
+  for (const char *i = s; *i != '\0' && _frameCol < _numcols; i++) {
+    _frame[_frameRow][_frameCol++] = *i;
+  }
+}
+
+void LiquidCrystal::framePrint(int value, uint8_t width)
+{
+  char text[12];
+  formatDec(text, sizeof(text), value, width);
+  framePrint(text);
+}
+
+void LiquidCrystal::framePrint(Q16 value, uint8_t decimals, uint8_t width)
+{
+  char text[20];
+  formatFixed(text, sizeof(text), value, decimals, width);
+  framePrint(text);
+}
+
+// Send the changed cells, returns the number of bytes sent to the display.
+// A cursor command costs as much as a character, so a single unchanged
+// cell between two changes is rewritten instead of skipped.
+int LiquidCrystal::flush()
+{
+  PROFILE_ZONE(PROFILE_LCD_PRINT);
+  int sent = 0;
+
+  for (uint8_t row = 0; row < _numlines; row++) {
+    int cursor = -1;  // display cursor column on this row, -1 if unknown
+    for (uint8_t col = 0; col < _numcols; col++) {
+      if (_frame[row][col] == _shown[row][col]) continue;
+      if (cursor >= 0 && col == cursor + 1) {
+        write(_frame[row][cursor]);
+        sent++;
+        cursor++;
+      }
+      if (cursor != col) {
+        setCursor(col, row);
+        sent++;
+      }
+      write(_frame[row][col]);
+      _shown[row][col] = _frame[row][col];
+      sent++;
+      cursor = col + 1;
+    }
+  }
+  return sent;
+}
+
+// force the next flush() to redraw every cell
+void LiquidCrystal::invalidate()
+{
+  memset(_shown, 0, sizeof(_shown));
+}
+
 void LiquidCrystal::setCursor(uint8_t col, uint8_t row)
 {
   int row_offsets[] = { 0x00, 0x40, 0x14, 0x54 };
@@ -258,19 +347,66 @@ inline size_t LiquidCrystal::write(uint8_t value) {
 
 // write either command or data
 void LiquidCrystal::send(uint8_t value, uint8_t mode) {
-  rs_pin->Write(mode); //digitalWrite(_rs_pin, mode);
+  enqueue(value, mode == HIGH ? OP_DATA : 0, EXEC_US);
+}
+
+// Blocks only while the queue is full.
+void LiquidCrystal::enqueue(uint8_t value, uint8_t flags, uint16_t delayUs) {
+  Op op = { value, flags, delayUs };
+
+  while (!_queue.push(op)) {
+    kick();
+    __WFI();
+  }
+  kick();
+}
+
+// Start draining if the interrupt is not already doing so. The timer
+// interrupt is masked so that it cannot go idle between the test and the
+// start.
+void LiquidCrystal::kick() {
+  NVIC_DisableIRQ(RITIMER_IRQn);
+  if (!_busy) {
+    _busy = true;
+    _timer.start(1);
+  }
+  NVIC_EnableIRQ(RITIMER_IRQn);
+}
 
-  write4bits(value>>4);
-  write4bits(value);
+void LiquidCrystal::waitIdle() {
+  while (_busy) {
+    __WFI();
+  }
+}
+
+// Timer interrupt: send the next queued byte (two nibbles, about 3 us)
+// and rearm the one-shot timer for its execution time.
+void LiquidCrystal::tick() {
+  Op op;
+
+  if (!_queue.pop(op)) {
+    _busy = false;
+    return;
+  }
+  if (!(op.flags & OP_WAIT)) {
+    rs_pin->Write(op.flags & OP_DATA); //digitalWrite(_rs_pin, mode);
+    if (!(op.flags & OP_NIBBLE)) {
+      write4bits(op.value>>4);
+    }
+    write4bits(op.value);
+  }
+  _timer.start(op.delayUs);
 }
 
 void LiquidCrystal::pulseEnable(void) {
-  enable_pin->Write(false); //digitalWrite(_enable_pin, LOW);
-  delayMicroseconds(1);
+  uint32_t start;
+
   enable_pin->Write(true); //digitalWrite(_enable_pin, HIGH);
-  delayMicroseconds(1);    // enable pulse must be >450ns
+  start = DWT->CYCCNT;
+  while (DWT->CYCCNT - start < _enableCycles);  // enable pulse must be >450ns
   enable_pin->Write(false); //digitalWrite(_enable_pin, LOW);
-  delayMicroseconds(100);   // commands need > 37us to settle
+  start = DWT->CYCCNT;
+  while (DWT->CYCCNT - start < _enableCycles);  // enable cycle time > 1000ns
 }
 
 void LiquidCrystal::write4bits(uint8_t value) {
@@ -6,6 +6,9 @@
 #include <string>
 #include "chip.h"
 #include "DigitalIoPin.h"
+#include "SpscRing.h"
+#include "FixedPoint.h"
+#include "TimerService.h"
 
 // commands
 #define LCD_CLEARDISPLAY 0x01
@@ -45,6 +48,10 @@
 #define LCD_5x10DOTS 0x04
 #define LCD_5x8DOTS 0x00
 
+// All display output is asynchronous: commands and characters go into a
+// queue that a software timer (TimerService) drains one byte at a time,
+// waiting the HD44780 execution time of each byte before the next one.
+// The functions below return immediately unless the queue is full.
 class LiquidCrystal {
 public:
 
@@ -75,9 +82,43 @@ public:
   void command(uint8_t);
   void print(std::string const &s);
   void print(const char *s);
+  // numbers are formatted on the stack, without std::to_string()
+  void print(int value, uint8_t width = 0);
+  void print(Q16 value, uint8_t decimals, uint8_t width = 0);
+
+  // Off-screen frame buffer: draw into RAM with the frame* functions and
+  // call flush() to send only the cells that differ from the display.
+  // After writing to the display directly, call invalidate().
+  static const uint8_t MAX_COLS = 20;
+  static const uint8_t MAX_ROWS = 4;
+  void frameClear();
+  void frameSetCursor(uint8_t col, uint8_t row);
+  void framePrint(std::string const &s);
+  void framePrint(const char *s);
+  void framePrint(int value, uint8_t width = 0);
+  void framePrint(Q16 value, uint8_t decimals, uint8_t width = 0);
+  int flush();
+  void invalidate();
+
+  bool isIdle() const { return !_busy; }
+  void waitIdle();
+  void tick();  // timer interrupt
 
 private:
+  // one queued transfer
+  struct Op {
+    uint8_t value;
+    uint8_t flags;
+    uint16_t delayUs;  // execution time to wait after it
+  };
+  static const uint8_t OP_DATA = 0x01;    // RS high
+  static const uint8_t OP_NIBBLE = 0x02;  // only the low nibble, for the 4-bit init sequence
+  static const uint8_t OP_WAIT = 0x04;    // nothing is sent, only the delay
+  static const uint16_t EXEC_US = 50;     // most commands and data need > 37 us
+
   void send(uint8_t, uint8_t);
+  void enqueue(uint8_t value, uint8_t flags, uint16_t delayUs);
+  void kick();
   void write4bits(uint8_t);
   void pulseEnable();
 
@@ -92,6 +133,16 @@ private:
   uint8_t _initialized;
 
   uint8_t _numlines,_currline;
+
+  SpscRing<Op, 64> _queue;
+  SoftTimer _timer;
+  volatile bool _busy;      // the timer interrupt is draining the queue
+  uint32_t _enableCycles;   // enable pulse width
+
+  uint8_t _numcols;
+  uint8_t _frameCol, _frameRow;
+  char _frame[MAX_ROWS][MAX_COLS];  // wanted contents
+  char _shown[MAX_ROWS][MAX_COLS];  // what the display shows
 };
 
 #endif
@@ -31,6 +31,8 @@ Arduino library for communicating with Modbus slaves over RS232/485 (via RTU pro
 /* _____PROJECT INCLUDES_____________________________________________________ */
 #include "ModbusMaster.h"
 #include "crc16.h"
+#include "Profiler.h"
+#include "Trace.h"
 
 
 /* _____GLOBAL VARIABLES_____________________________________________________ */
@@ -147,8 +149,14 @@ void ModbusMaster::begin(uint16_t u16BaudRate)
       break;
   }
 
+  // t3.5 is 3.5 character times of 11 bits; the spec fixes it at 1.75 ms above 19200 baud
+  _u16BaudRate = u16BaudRate;
+  _u32T35Us = (u16BaudRate > 19200) ? 1750 : 38500000UL / u16BaudRate;
+  if (_frameAssembler) _frameAssembler->setGapTimeout(_u32T35Us);
+
   if(MBSerial == NULL) MBSerial = new SerialPort;
   MBSerial->begin(u16BaudRate);
+  MBSerial->setFrameAssembler(_frameAssembler);
   _idle = NULL;
 #if __MODBUSMASTER_DEBUG__
 //  pinMode(4, OUTPUT);
@@ -269,6 +277,34 @@ void ModbusMaster::idle(void (*idle)())
 }
 
 
+/**
+Enable or disable receive-side frame assembly.
+
+In frame mode the UART interrupt assembles the response as the bytes
+arrive, checks the CRC incrementally and applies the length rules of the
+requested function code. ModbusMasterTransaction() then only waits for a
+complete, pre-validated frame; corrupted responses are dropped by the ISR
+and surface as ku8MBResponseTimedOut.
+
+@param bEnable true to assemble responses in the UART ISR
+*/
+void ModbusMaster::setFrameMode(bool bEnable)
+{
+  if (bEnable && _frameAssembler == NULL)
+  {
+    _frameAssembler = new RtuFrameAssembler;
+    _frameAssembler->setGapTimeout(_u32T35Us);
+  }
+  else if (!bEnable && _frameAssembler != NULL)
+  {
+    if (MBSerial != NULL) MBSerial->setFrameAssembler(NULL);
+    delete _frameAssembler;
+    _frameAssembler = NULL;
+  }
+  if (MBSerial != NULL) MBSerial->setFrameAssembler(_frameAssembler);
+}
+
+
 /**
 Retrieve data from response buffer.
 
@@ -651,7 +687,10 @@ Sequence:
 */
 uint8_t ModbusMaster::ModbusMasterTransaction(uint8_t u8MBFunction)
 {
+  PROFILE_ZONE(PROFILE_MODBUS_TRANSACTION);
   uint8_t u8ModbusADU[256];
+  const uint8_t *pu8ResponseADU = u8ModbusADU;
+  const RtuFrame *pFrame = NULL;
   uint8_t u8ModbusADUSize = 0;
   uint8_t i, u8Qty;
   uint16_t u16CRC;
@@ -753,8 +792,22 @@ uint8_t ModbusMaster::ModbusMasterTransaction(uint8_t u8MBFunction)
   u8ModbusADU[u8ModbusADUSize++] = highByte(u16CRC);
   u8ModbusADU[u8ModbusADUSize] = 0;
 
+  // the bus must stay silent for t3.5 between frames
+  while (elapsedUs(_u32LastFrameUs, micros()) < _u32T35Us)
+  {
+    if (_idle)
+    {
+      _idle();
+    }
+  }
+
   // flush receive buffer before transmitting request
   while (MBSerial->read() != -1);
+  if (_frameAssembler)
+  {
+    while (_frameAssembler->peekFrame()) _frameAssembler->releaseFrame();
+    _frameAssembler->arm(_u8MBSlave, u8MBFunction);
+  }
 
 #if 0
   // transmit request
@@ -773,8 +826,37 @@ uint8_t ModbusMaster::ModbusMasterTransaction(uint8_t u8MBFunction)
   u8ModbusADUSize = 0;
   MBSerial->flush();    // flush transmit buffer
 
+  u32StartTime = micros();
+  if (_frameAssembler)
+  {
+    // frame mode: the UART ISR has already checked slave ID, function code,
+    // length and CRC, so there is nothing left to do byte by byte
+    u8BytesLeft = 0;
+    while (!(pFrame = _frameAssembler->peekFrame()))
+    {
+      if (_idle)
+      {
+        _idle();
+      }
+      if (elapsedUs(u32StartTime, micros()) > ku16MBResponseTimeout * 1000UL)
+      {
+        _frameAssembler->disarm();
+        u8MBStatus = ku8MBResponseTimedOut;
+        break;
+      }
+    }
+    if (pFrame)
+    {
+      pu8ResponseADU = pFrame->data;
+      // check whether Modbus exception occurred; return Modbus Exception Code
+      if (bitRead(pu8ResponseADU[1], 7))
+      {
+        u8MBStatus = pu8ResponseADU[2];
+      }
+    }
+  }
+
   // loop until we run out of time or bytes, or an error occurs
-  u32StartTime = millis();
   while (u8BytesLeft && !u8MBStatus)
   {
     if (MBSerial->available())
@@ -849,7 +931,7 @@ uint8_t ModbusMaster::ModbusMasterTransaction(uint8_t u8MBFunction)
           break;
       }
     }
-    if ((millis() - u32StartTime) > ku16MBResponseTimeout)
+    if (elapsedUs(u32StartTime, micros()) > ku16MBResponseTimeout * 1000UL)
     {
       u8MBStatus = ku8MBResponseTimedOut;
     }
@@ -877,27 +959,27 @@ uint8_t ModbusMaster::ModbusMasterTransaction(uint8_t u8MBFunction)
   if (!u8MBStatus)
   {
     // evaluate returned Modbus function code
-    switch(u8ModbusADU[1])
+    switch(pu8ResponseADU[1])
     {
       case ku8MBReadCoils:
       case ku8MBReadDiscreteInputs:
         // load bytes into word; response bytes are ordered L, H, L, H, ...
-        for (i = 0; i < (u8ModbusADU[2] >> 1); i++)
+        for (i = 0; i < (pu8ResponseADU[2] >> 1); i++)
         {
           if (i < ku8MaxBufferSize)
           {
-            _u16ResponseBuffer[i] = word(u8ModbusADU[2 * i + 4], u8ModbusADU[2 * i + 3]);
+            _u16ResponseBuffer[i] = word(pu8ResponseADU[2 * i + 4], pu8ResponseADU[2 * i + 3]);
           }
 
           _u8ResponseBufferLength = i;
         }
 
         // in the event of an odd number of bytes, load last byte into zero-padded word
-        if (u8ModbusADU[2] % 2)
+        if (pu8ResponseADU[2] % 2)
         {
           if (i < ku8MaxBufferSize)
           {
-            _u16ResponseBuffer[i] = word(0, u8ModbusADU[2 * i + 3]);
+            _u16ResponseBuffer[i] = word(0, pu8ResponseADU[2 * i + 3]);
           }
 
           _u8ResponseBufferLength = i + 1;
@@ -908,11 +990,11 @@ uint8_t ModbusMaster::ModbusMasterTransaction(uint8_t u8MBFunction)
       case ku8MBReadHoldingRegisters:
       case ku8MBReadWriteMultipleRegisters:
         // load bytes into word; response bytes are ordered H, L, H, L, ...
-        for (i = 0; i < (u8ModbusADU[2] >> 1); i++)
+        for (i = 0; i < (pu8ResponseADU[2] >> 1); i++)
         {
           if (i < ku8MaxBufferSize)
           {
-            _u16ResponseBuffer[i] = word(u8ModbusADU[2 * i + 3], u8ModbusADU[2 * i + 4]);
+            _u16ResponseBuffer[i] = word(pu8ResponseADU[2 * i + 3], pu8ResponseADU[2 * i + 4]);
           }
 
           _u8ResponseBufferLength = i;
@@ -921,6 +1003,16 @@ uint8_t ModbusMaster::ModbusMasterTransaction(uint8_t u8MBFunction)
     }
   }
 
+  if (pFrame)
+  {
+    _frameAssembler->releaseFrame();
+  }
+  _u32LastFrameUs = micros();
+  // response time from the end of the request
+  traceEvent(TRACE_MODBUS, TRACE_MODBUS_TRANSACTION,
+             _u8MBSlave | (uint32_t)u8MBFunction << 8 | (uint32_t)u8MBStatus << 16,
+             elapsedUs(u32StartTime, _u32LastFrameUs));
+
   _u8TransmitBufferIndex = 0;
   u16TransmitBufferLength = 0;
   _u8ResponseBufferIndex = 0;
@@ -58,6 +58,7 @@ Set to 1 to enable debugging features within class:
 #endif
 
 uint32_t millis();
+#include "Clock.h"
 #define BYTE 0xA5
 
 /* _____UTILITY MACROS_______________________________________________________ */
@@ -74,6 +75,7 @@ uint32_t millis();
 
 
 #include "SerialPort.h"
+#include "ModbusRegister.h"
 
 /* _____CLASS DEFINITIONS____________________________________________________ */
 /**
@@ -90,6 +92,8 @@ class ModbusMaster
     void begin();
     void begin(uint16_t);
     void idle(void (*)());
+    void setFrameMode(bool);
+    SerialPort *getSerialPort() { return MBSerial; } ///< for line error statistics; NULL before begin()
 
     // Modbus exception codes
     /**
@@ -232,10 +236,68 @@ class ModbusMaster
     uint8_t  readWriteMultipleRegisters(uint16_t, uint16_t, uint16_t, uint16_t);
     uint8_t  readWriteMultipleRegisters(uint16_t, uint16_t);
 
+    /**
+    Write a typed register (see ModbusRegister.h); the value is scaled to
+    the raw register value.
+
+    @param value engineering value
+    @return 0 on success; exception number on failure
+    @ingroup register
+    */
+    template <typename R>
+    uint8_t writeRegister(typename R::Value value)
+    {
+      return writeSingleRegister(R::address, R::encode(value));
+    }
+
+    /**
+    Read a typed register; value is only written on success.
+
+    @param value engineering value read from the slave
+    @return 0 on success; exception number on failure
+    @ingroup register
+    */
+    template <typename R>
+    uint8_t readRegister(typename R::Value &value)
+    {
+      uint8_t u8Result = readHoldingRegisters(R::address, 1);
+      if (u8Result == ku8MBSuccess)
+      {
+        value = R::decode(getResponseBuffer(0));
+      }
+      return u8Result;
+    }
+
+    /**
+    Read all registers of a RegisterBlock in one transaction; fetch them
+    with getBlockValue() afterwards.
+
+    @return 0 on success; exception number on failure
+    @ingroup register
+    */
+    template <typename B>
+    uint8_t readBlock()
+    {
+      return readHoldingRegisters(B::address, B::count);
+    }
+
+    /**
+    Value of register R from the latest readBlock<B>().
+
+    @ingroup register
+    */
+    template <typename B, typename R>
+    typename R::Value getBlockValue()
+    {
+      return R::decode(getResponseBuffer(B::template indexOf<R>()));
+    }
+
   private:
     uint8_t  _u8SerialPort;                                      ///< serial port (0..3) initialized in constructor
     uint8_t  _u8MBSlave;                                         ///< Modbus slave (1..255) initialized in constructor
     uint16_t _u16BaudRate;                                       ///< baud rate (300..115200) initialized in begin()
+    uint32_t _u32T35Us = 1750;                                   ///< inter-frame silence t3.5 [microseconds] for _u16BaudRate
+    uint32_t _u32LastFrameUs = 0;                                ///< micros() at the end of the previous transaction
     static const uint8_t ku8MaxBufferSize                = 64;   ///< size of response/transmit buffers
     uint16_t _u16ReadAddress;                                    ///< slave register from which to read
     uint16_t _u16ReadQty;                                        ///< quantity of words to read
@@ -264,7 +326,7 @@ class ModbusMaster
     static const uint8_t ku8MBMaskWriteRegister          = 0x16; ///< Modbus function 0x16 Mask Write Register
     static const uint8_t ku8MBReadWriteMultipleRegisters = 0x17; ///< Modbus function 0x17 Read Write Multiple Registers
 
-    // Modbus timeout [milliseconds]
+    // Modbus timeout [milliseconds], measured on micros()
     static const uint16_t ku16MBResponseTimeout          = 2000; ///< Modbus timeout [milliseconds]
 
     // master function that conducts Modbus transactions
@@ -273,6 +335,7 @@ class ModbusMaster
     // idle callback function; gets called during idle time between TX and RX
     void (*_idle)();
     SerialPort *MBSerial = NULL; // added by KRL
+    RtuFrameAssembler *_frameAssembler = NULL; ///< ISR-side response assembler; NULL unless frame mode is enabled
 };
 #endif
 
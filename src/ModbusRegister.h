@@ -0,0 +1,71 @@
+/*
+ * ModbusRegister.h
+ *
+ *  Created on: 19.10.2026
+ *
+ * Compile-time description of Modbus holding registers. A Register binds
+ * an address to an engineering type and a linear scale
+ *     raw = value * Num / Den
+ * so that encoding and decoding are constexpr and fold away for constants.
+ * A RegisterBlock lists registers that must be contiguous (checked at
+ * compile time) and can therefore be read with one transaction; indexOf
+ * gives a register's position in the response buffer.
+ * ModbusMaster::readRegister/writeRegister/readBlock use these types.
+ */
+
+#ifndef MODBUSREGISTER_H_
+#define MODBUSREGISTER_H_
+
+#include <stdint.h>
+
+template <int32_t Num, int32_t Den = 1>
+struct Scale {
+	static_assert(Num > 0 && Den > 0, "scale must be positive");
+	// rounded to nearest, values are non-negative on the drive side
+	static constexpr uint16_t encode(int32_t value) {
+		return (uint16_t)(((int64_t)value * Num + Den / 2) / Den);
+	}
+	static constexpr int32_t decode(uint16_t raw) {
+		return (int32_t)(((int64_t)raw * Den + Num / 2) / Num);
+	}
+};
+
+typedef Scale<1> Unscaled;
+
+template <uint16_t Addr, typename T = uint16_t, typename S = Unscaled>
+struct Register {
+	typedef T Value;
+	static constexpr uint16_t address = Addr;
+	static constexpr uint16_t encode(T value) { return S::encode((int32_t)value); }
+	static constexpr T decode(uint16_t raw) { return (T)S::decode(raw); }
+};
+
+template <typename... Regs>
+struct RegistersContiguous;
+
+template <typename R>
+struct RegistersContiguous<R> {
+	static constexpr bool value = true;
+};
+
+template <typename A, typename B, typename... Rest>
+struct RegistersContiguous<A, B, Rest...> {
+	static constexpr bool value = B::address == A::address + 1 && RegistersContiguous<B, Rest...>::value;
+};
+
+template <typename First, typename... Rest>
+struct RegisterBlock {
+	static_assert(RegistersContiguous<First, Rest...>::value, "registers of a block must be contiguous");
+	static constexpr uint16_t address = First::address;
+	static constexpr uint16_t count = 1 + sizeof...(Rest);
+
+	// position of R in the response buffer of a block read
+	template <typename R>
+	static constexpr uint8_t indexOf() {
+		static_assert(R::address >= First::address && R::address < First::address + 1 + sizeof...(Rest),
+				"register is not part of the block");
+		return R::address - First::address;
+	}
+};
+
+#endif /* MODBUSREGISTER_H_ */
@@ -0,0 +1,112 @@
+/*
+ * PidController.h
+ *
+ *  Created on: 19.10.2026
+ *
+ * Fixed-point PID controller with per-instance state, so one board can run
+ * several loops. Compared to FixedPid it adds
+ *  - conditional integration: the integral is frozen while the output is
+ *    saturated and the error would drive it further into saturation,
+ *  - derivative on measurement through a first-order low-pass filter, so
+ *    setpoint steps do not kick the output,
+ *  - bumpless transfer from manual to automatic mode: the integral is
+ *    preloaded so that the first automatic output equals the manual one.
+ * Time is in milliseconds, as in the original pid().
+ */
+
+#ifndef PIDCONTROLLER_H_
+#define PIDCONTROLLER_H_
+
+#include <stdint.h>
+#include "FixedPoint.h"
+
+template <int F = 16>
+class PidController {
+public:
+	typedef Fixed<F> Num;
+
+	PidController(Num kp, Num ki, Num kd, Num outMin = Num::fromInt(0), Num outMax = Num::fromInt(100)) :
+		kp(kp), ki(ki), kd(kd), outMin(outMin), outMax(outMax), dAlpha(Num::fromFloat(0.25f)),
+		out(outMin), automatic(false), initialize(true) {}
+
+	void setGains(Num kp, Num ki, Num kd) { this->kp = kp; this->ki = ki; this->kd = kd; }
+	Num getKp() const { return kp; }
+	Num getKi() const { return ki; }
+	Num getKd() const { return kd; }
+
+	/* weight of a new derivative sample, 0 < alpha <= 1 (1 = unfiltered) */
+	void setDerivativeFilter(Num alpha) { dAlpha = alpha; }
+
+	/* Manual mode: the output is held at the given value until setAutomatic() */
+	void setManual(Num output) { out = clamp(output); automatic = false; }
+	void setAutomatic() {
+		if(!automatic) initialize = true;
+		automatic = true;
+	}
+	bool isAutomatic() const { return automatic; }
+
+	Num update(Num setpoint, Num measurement, uint32_t dtMs, Num feedforward = Num()) {
+		Num error = setpoint - measurement;
+		Num pTerm = kp * error;
+		Num dRaw;
+
+		if(!automatic) return out;
+		if(dtMs == 0) dtMs = 1;
+
+		if(initialize) {
+			// bumpless transfer: start the integral where the output already is
+			initialize = false;
+			iTerm = out - feedforward - pTerm;
+			this->pTerm = pTerm;
+			dTerm = Num();
+			lastMeasurement = measurement;
+			return out;
+		}
+		dRaw = -(kd * (measurement - lastMeasurement)) / (int32_t)dtMs;
+		dTerm += (dRaw - dTerm) * dAlpha;
+		lastMeasurement = measurement;
+
+		Num iNext = iTerm + ki * error * (int32_t)dtMs;
+		Num unsat = feedforward + pTerm + iNext + dTerm;
+		if(!((unsat > outMax && error > Num()) || (unsat < outMin && error < Num()))) {
+			iTerm = iNext;
+		}
+
+		this->pTerm = pTerm;
+		out = clamp(feedforward + pTerm + iTerm + dTerm);
+		return out;
+	}
+
+	Num output() const { return out; }
+	Num proportional() const { return pTerm; }
+	Num integral() const { return iTerm; }
+	Num derivative() const { return dTerm; }
+
+	void reset() {
+		pTerm = Num();
+		iTerm = Num();
+		dTerm = Num();
+		out = outMin;
+		initialize = true;
+	}
+
+private:
+	Num clamp(Num v) const {
+		if(v > outMax) return outMax;
+		if(v < outMin) return outMin;
+		return v;
+	}
+
+	Num kp, ki, kd;
+	Num outMin, outMax;
+	Num dAlpha;
+	Num pTerm;
+	Num iTerm;
+	Num dTerm;
+	Num lastMeasurement;
+	Num out;
+	bool automatic;
+	bool initialize;	// next automatic update performs the bumpless transfer
+};
+
+#endif /* PIDCONTROLLER_H_ */
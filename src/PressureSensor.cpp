@@ -0,0 +1,137 @@
+/*
+ * PressureSensor.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "PressureSensor.h"
+
+/* scaleFactor is the sensor's counts per pascal (240 for SDP610-125Pa,
+ * 60 for SDP610-500Pa). The altitude correction is folded into the same
+ * constant so that a sample needs only one multiply and one shift.
+ */
+PressureSensor::PressureSensor(I2C &i2c, uint8_t address, int scaleFactor) :
+	i2c(i2c), address(address), resolution(12), lastError(OK), i2cErrors(0), crcErrors(0),
+	reading(false), readCmd(CMD_TRIGGER_MEASUREMENT), readCallback(NULL), readContext(NULL) {
+	int32_t divisor = 100 * scaleFactor;
+	scaleQ22 = (((int32_t)ALTITUDE_CORRECTION << 22) + divisor / 2) / divisor;
+}
+
+/* CRC-8 as specified by Sensirion: polynomial x^8 + x^5 + x^4 + 1 (0x31),
+ * initial value 0x00.
+ */
+uint8_t PressureSensor::crc8(const uint8_t *data, int len) {
+	uint8_t crc = 0;
+
+	for(int i = 0; i < len; i++) {
+		crc ^= data[i];
+		for(int bit = 0; bit < 8; bit++) {
+			if(crc & 0x80) crc = (crc << 1) ^ 0x31;
+			else crc = crc << 1;
+		}
+	}
+	return crc;
+}
+
+int32_t PressureSensor::toPascal(int16_t raw) const {
+	// Q0 * Q22 -> Q22, rounded to Q16
+	return (int32_t)(((int64_t)raw * scaleQ22 + (1 << 5)) >> 6);
+}
+
+PressureSensor::Status PressureSensor::fail(Status status) {
+	if(status == I2C_ERROR) i2cErrors++;
+	else if(status == CRC_ERROR) crcErrors++;
+	lastError = status;
+	return status;
+}
+
+/* The sample is only written when the CRC matches, so a corrupted value
+ * can never reach the caller.
+ */
+PressureSensor::Status PressureSensor::decode(const uint8_t *data, Sample &sample) {
+	if(crc8(data, 2) != data[2]) return fail(CRC_ERROR);
+
+	sample.raw = (int16_t)((data[0] << 8) | data[1]);
+	sample.pascal = toPascal(sample.raw);
+	lastError = OK;
+	return OK;
+}
+
+/* Trigger a measurement and read it back, blocking until it is done. */
+PressureSensor::Status PressureSensor::read(Sample &sample) {
+	uint8_t cmd = CMD_TRIGGER_MEASUREMENT;
+	uint8_t data[3];
+
+	if(!i2c.transaction(address, &cmd, 1, data, 3)) return fail(I2C_ERROR);
+	return decode(data, sample);
+}
+
+/* Queue a measurement and return immediately. The callback gets the status
+ * and, on OK, the validated sample. Returns false if a read is already in
+ * progress or the I2C queue is full.
+ */
+bool PressureSensor::startRead(ReadCallback callback, void *context) {
+	if(reading) return false;
+	reading = true;
+	readCallback = callback;
+	readContext = context;
+	if(!i2c.submit(address, &readCmd, 1, readData, 3, onReadComplete, this)) {
+		reading = false;
+		return false;
+	}
+	return true;
+}
+
+void PressureSensor::onReadComplete(void *context, uint16_t status) {
+	PressureSensor *sensor = static_cast<PressureSensor *>(context);
+	Sample sample = { 0, 0 };
+	Status result;
+
+	if(status != I2CM_STATUS_OK) result = sensor->fail(I2C_ERROR);
+	else result = sensor->decode(sensor->readData, sample);
+
+	sensor->reading = false;
+	if(sensor->readCallback != NULL) sensor->readCallback(sensor->readContext, result, sample);
+}
+
+PressureSensor::Status PressureSensor::readUserRegister(uint16_t &value) {
+	uint8_t cmd = CMD_READ_USER_REGISTER;
+	uint8_t data[3];
+
+	if(!i2c.transaction(address, &cmd, 1, data, 3)) return fail(I2C_ERROR);
+	if(crc8(data, 2) != data[2]) return fail(CRC_ERROR);
+
+	value = (data[0] << 8) | data[1];
+	return OK;
+}
+
+/* The conversion time roughly doubles with every extra bit, from about
+ * 4.6 ms at the default 12 bits to 74 ms at 16 bits. The sensor stretches
+ * the clock for that long, so it counts against the I2C timeout.
+ */
+uint32_t PressureSensor::conversionTimeUs(uint8_t bits) {
+	return bits >= 12 ? CONVERSION_12BIT_US << (bits - 12) : CONVERSION_12BIT_US >> (12 - bits);
+}
+
+/* Measurement resolution 9..16 bits. The I2C timeout is set to twice the
+ * conversion time, but never below its default, so that 15 and 16 bit
+ * reads do not time out.
+ */
+PressureSensor::Status PressureSensor::setResolution(uint8_t bits) {
+	uint16_t reg;
+	Status status;
+
+	if(bits < 9 || bits > 16) return fail(BAD_ARGUMENT);
+	status = readUserRegister(reg);
+	if(status != OK) return status;
+
+	reg = (reg & ~RESOLUTION_MASK) | ((uint16_t)(bits - 9) << RESOLUTION_SHIFT);
+	uint8_t data[3] = { CMD_WRITE_USER_REGISTER, (uint8_t)(reg >> 8), (uint8_t)reg };
+	if(!i2c.transaction(address, data, 3, NULL, 0)) return fail(I2C_ERROR);
+
+	uint32_t timeoutMs = 2 * conversionTimeUs(bits) / 1000 + 1;
+	i2c.setTimeout(timeoutMs > I2C::DEFAULT_TIMEOUT_MS ? timeoutMs : I2C::DEFAULT_TIMEOUT_MS);
+	resolution = bits;
+	lastError = OK;
+	return OK;
+}
@@ -0,0 +1,75 @@
+/*
+ * PressureSensor.h
+ *
+ *  Created on: 19.10.2026
+ *
+ * Driver for the Sensirion SDP6x differential pressure sensor on the I2C bus.
+ * Every measurement is checked against the sensor's CRC-8 and converted to
+ * pascals with a single fixed-point multiply; no floating point is used.
+ */
+
+#ifndef PRESSURESENSOR_H_
+#define PRESSURESENSOR_H_
+
+#include <stdint.h>
+#include "I2C.h"
+
+class PressureSensor {
+public:
+	enum Status { OK, I2C_ERROR, CRC_ERROR, BAD_ARGUMENT };
+
+	struct Sample {
+		int16_t raw;		// sensor output in counts
+		int32_t pascal;		// pressure in Pa, Q16.16
+	};
+
+	/* called from interrupt context when an asynchronous read completes */
+	typedef void (*ReadCallback)(void *context, Status status, const Sample &sample);
+
+	PressureSensor(I2C &i2c, uint8_t address = 0x40, int scaleFactor = 240);
+	Status read(Sample &sample);
+	bool startRead(ReadCallback callback, void *context);
+	bool isReading() const { return reading; }
+	Status setResolution(uint8_t bits);
+	uint8_t getResolution() const { return resolution; }
+	static uint32_t conversionTimeUs(uint8_t bits);
+	uint32_t readTimeUs() const { return conversionTimeUs(resolution) + TRANSFER_US; }
+	Status getLastError() const { return lastError; }
+	uint32_t getI2cErrors() const { return i2cErrors; }
+	uint32_t getCrcErrors() const { return crcErrors; }
+
+	int32_t toPascal(int16_t raw) const;
+	static int toIntPa(int32_t pascal) { return (pascal + (1 << 15)) >> 16; }
+	static uint8_t crc8(const uint8_t *data, int len);
+private:
+	Status fail(Status status);
+	Status decode(const uint8_t *data, Sample &sample);
+	static void onReadComplete(void *context, uint16_t status);
+	Status readUserRegister(uint16_t &value);
+
+	I2C &i2c;
+	uint8_t address;
+	uint8_t resolution;		// bits
+	int32_t scaleQ22;		// Pa per count in Q10.22
+	Status lastError;
+	uint32_t i2cErrors;
+	uint32_t crcErrors;
+
+	// state of the asynchronous read
+	volatile bool reading;
+	uint8_t readCmd;
+	uint8_t readData[3];
+	ReadCallback readCallback;
+	void *readContext;
+
+	static const uint8_t CMD_TRIGGER_MEASUREMENT = 0xF1;
+	static const uint8_t CMD_WRITE_USER_REGISTER = 0xE4;
+	static const uint8_t CMD_READ_USER_REGISTER = 0xE5;
+	static const uint16_t RESOLUTION_MASK = 0x0E00;	// user register bits 11:9
+	static const int RESOLUTION_SHIFT = 9;
+	static const int ALTITUDE_CORRECTION = 95;		// percent, see datasheet
+	static const uint32_t CONVERSION_12BIT_US = 4600;
+	static const uint32_t TRANSFER_US = 540;		// 6 bytes with ACKs at 100 kHz
+};
+
+#endif /* PRESSURESENSOR_H_ */
@@ -0,0 +1,69 @@
+/*
+ * Profiler.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "Profiler.h"
+
+#if PROFILING
+
+#include <stdio.h>
+
+ProfileStats profileTable[PROFILE_ZONE_COUNT];
+
+static const char * const zoneNames[PROFILE_ZONE_COUNT] = {
+	"modbus_transaction",
+	"uart_isr",
+	"filter",
+	"pid",
+	"control_step",
+	"lcd_print",
+};
+
+void profileInit() {
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	profileReset();
+}
+
+void profileReset() {
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	for(int i = 0; i < PROFILE_ZONE_COUNT; i++) {
+		profileTable[i].count = 0;
+		profileTable[i].min = UINT32_MAX;
+		profileTable[i].max = 0;
+		profileTable[i].total = 0;
+	}
+	__set_PRIMASK(primask);
+}
+
+/* One line per zone, framed by begin/end lines so the host reporter can
+ * pick the table out of other ITM output:
+ *     PROF begin <core clock Hz>
+ *     PROF <zone> <count> <min> <avg> <max> <total high> <total low>
+ *     PROF end
+ * newlib-nano printf has no %llu, so the 64-bit total is split.
+ */
+void profileDump() {
+	ProfileStats copy[PROFILE_ZONE_COUNT];
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	for(int i = 0; i < PROFILE_ZONE_COUNT; i++) copy[i] = profileTable[i];
+	__set_PRIMASK(primask);
+
+	printf("PROF begin %lu\n", (unsigned long)SystemCoreClock);
+	for(int i = 0; i < PROFILE_ZONE_COUNT; i++) {
+		ProfileStats &s = copy[i];
+		uint32_t avg = s.count ? (uint32_t)(s.total / s.count) : 0;
+		printf("PROF %s %lu %lu %lu %lu %lu %lu\n", zoneNames[i], (unsigned long)s.count,
+				(unsigned long)(s.count ? s.min : 0), (unsigned long)avg, (unsigned long)s.max,
+				(unsigned long)(s.total >> 32), (unsigned long)(uint32_t)s.total);
+	}
+	printf("PROF end\n");
+}
+
+#endif /* PROFILING */
@@ -0,0 +1,86 @@
+/*
+ * Profiler.h
+ *
+ *  Created on: 19.10.2026
+ *
+ * Cycle-accurate zone profiling on the DWT cycle counter. Put
+ *     PROFILE_ZONE(PROFILE_FILTER);
+ * at the top of a block and the cycles until the end of the block are
+ * added to that zone's count/min/max/total. Times are inclusive: a zone
+ * in the main loop also counts the interrupts that preempted it.
+ *
+ * Profiling is compiled in only with PROFILING set to 1 (here or with
+ * -DPROFILING=1); otherwise PROFILE_ZONE expands to nothing and the
+ * table is not linked in. profileDump() prints the table over ITM in the
+ * format read by tools/profreport.py.
+ */
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <stdint.h>
+
+#ifndef PROFILING
+#define PROFILING 0
+#endif
+
+enum ProfileZoneId {
+	PROFILE_MODBUS_TRANSACTION,
+	PROFILE_UART_ISR,
+	PROFILE_FILTER,
+	PROFILE_PID,
+	PROFILE_CONTROL_STEP,
+	PROFILE_LCD_PRINT,
+	PROFILE_ZONE_COUNT
+};
+
+#if PROFILING
+
+#include "chip.h"
+
+struct ProfileStats {
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t total;
+};
+
+extern ProfileStats profileTable[PROFILE_ZONE_COUNT];
+
+void profileInit();
+void profileReset();
+void profileDump();
+
+static inline void profileRecord(ProfileZoneId zone, uint32_t cycles) {
+	ProfileStats &stats = profileTable[zone];
+
+	stats.count++;
+	stats.total += cycles;
+	if(cycles < stats.min) stats.min = cycles;
+	if(cycles > stats.max) stats.max = cycles;
+}
+
+class ProfileScope {
+public:
+	ProfileScope(ProfileZoneId zone) : zone(zone), start(DWT->CYCCNT) {}
+	~ProfileScope() { profileRecord(zone, DWT->CYCCNT - start); }
+private:
+	ProfileZoneId zone;
+	uint32_t start;
+};
+
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+#define PROFILE_ZONE(zone) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(zone)
+
+#else
+
+static inline void profileInit() {}
+static inline void profileReset() {}
+static inline void profileDump() {}
+
+#define PROFILE_ZONE(zone) do {} while(0)
+
+#endif /* PROFILING */
+
+#endif /* PROFILER_H_ */
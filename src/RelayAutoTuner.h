@@ -0,0 +1,135 @@
+/*
+ * RelayAutoTuner.h
+ *
+ *  Created on: 19.10.2026
+ *
+ * Relay-feedback (Astrom-Hagglund) auto-tuning. While running, the tuner
+ * replaces the PID: it switches the fan output between bias + d and bias - d
+ * whenever the pressure crosses the setpoint (with hysteresis), which makes
+ * the loop oscillate at its ultimate period Pu. From the oscillation
+ * amplitude a the ultimate gain is Ku = 4d / (pi a), and PID gains follow
+ * from the Ziegler-Nichols "some overshoot" rule
+ *     Kp = Ku / 3, Ti = Pu / 2, Td = Pu / 3
+ * in the units of PidController (time in ms).
+ *
+ * The class has no hardware dependencies, so it can be driven by the plant
+ * simulator on the host exactly as by the control loop on the board.
+ */
+
+#ifndef RELAYAUTOTUNER_H_
+#define RELAYAUTOTUNER_H_
+
+#include <stdint.h>
+#include "FixedPoint.h"
+
+template <int F = 16>
+class RelayAutoTuner {
+public:
+	typedef Fixed<F> Num;
+	enum State { IDLE, RUNNING, DONE, FAILED };
+
+	RelayAutoTuner() : state(IDLE) {}
+
+	/* Start the experiment around the current operating point. bias is the
+	 * output that roughly holds the setpoint (e.g. the current PID output). */
+	void start(Num setpoint, Num bias, Num amplitude, Num hysteresis, uint32_t nowMs, uint32_t timeoutMs = 180000) {
+		this->setpoint = setpoint;
+		this->bias = bias;
+		this->amplitude = amplitude;
+		this->hysteresis = hysteresis;
+		this->timeoutMs = timeoutMs;
+		startTime = nowMs;
+		relayHigh = true;
+		output = clamp(bias + amplitude);
+		switched = false;
+		cycles = 0;
+		measured = 0;
+		sumPeriod = 0;
+		sumSwing = Num();
+		peakHigh = Num::min();
+		peakLow = Num::max();
+		state = RUNNING;
+	}
+
+	/* Feed the (filtered) measurement, returns the relay output */
+	Num update(Num measurement, uint32_t nowMs) {
+		if(state != RUNNING) return output;
+		if(nowMs - startTime > timeoutMs) {
+			state = FAILED;
+			output = bias;
+			return output;
+		}
+
+		if(measurement > peakHigh) peakHigh = measurement;
+		if(measurement < peakLow) peakLow = measurement;
+
+		if(relayHigh && measurement > setpoint + hysteresis) {
+			// switching down closes a full cycle of the oscillation
+			relayHigh = false;
+			output = clamp(bias - amplitude);
+			if(switched && ++cycles > SKIP_CYCLES) {
+				sumPeriod += nowMs - lastSwitch;
+				sumSwing += peakHigh - peakLow;
+				if(++measured == CYCLES) finish();
+			}
+			switched = true;
+			lastSwitch = nowMs;
+			peakHigh = measurement;
+			peakLow = measurement;
+		}
+		else if(!relayHigh && measurement < setpoint - hysteresis) {
+			relayHigh = true;
+			output = clamp(bias + amplitude);
+		}
+		return output;
+	}
+
+	void reset() { state = IDLE; }
+	State getState() const { return state; }
+	Num getUltimateGain() const { return ku; }
+	uint32_t getUltimatePeriod() const { return pu; }
+	Num getKp() const { return kp; }
+	Num getKi() const { return ki; }
+	Num getKd() const { return kd; }
+
+private:
+	static const int SKIP_CYCLES = 1;	// the first cycle starts off the operating point
+	static const int CYCLES = 4;		// cycles averaged for Ku and Pu
+
+	void finish() {
+		Num a = sumSwing / (int32_t)(2 * CYCLES);
+
+		output = bias;
+		pu = sumPeriod / CYCLES;
+		if(a <= Num() || pu == 0) {
+			state = FAILED;
+			return;
+		}
+		ku = amplitude * 4 / (a * Num::fromFloat(3.14159265f));
+		kp = ku / 3;
+		ki = kp * 2 / (int32_t)pu;
+		kd = kp * (int32_t)pu / 3;
+		state = DONE;
+	}
+
+	static Num clamp(Num v) {
+		if(v > Num::fromInt(100)) return Num::fromInt(100);
+		if(v < Num()) return Num();
+		return v;
+	}
+
+	State state;
+	Num setpoint, bias, amplitude, hysteresis;
+	Num output;
+	bool relayHigh;
+	bool switched;		// lastSwitch is valid
+	uint32_t startTime, timeoutMs, lastSwitch;
+	int cycles, measured;
+	uint32_t sumPeriod;
+	Num sumSwing;
+	Num peakHigh, peakLow;
+	Num ku, kp, ki, kd;
+	uint32_t pu;
+};
+
+#endif /* RELAYAUTOTUNER_H_ */
@@ -0,0 +1,144 @@
+/*
+ * RtuFrameAssembler.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "RtuFrameAssembler.h"
+#include <cstddef>
+#include "crc16.h"
+
+// Modbus function codes whose response length the assembler knows
+static const uint8_t MB_READ_COILS = 0x01;
+static const uint8_t MB_READ_DISCRETE_INPUTS = 0x02;
+static const uint8_t MB_READ_HOLDING_REGISTERS = 0x03;
+static const uint8_t MB_READ_INPUT_REGISTERS = 0x04;
+static const uint8_t MB_WRITE_SINGLE_COIL = 0x05;
+static const uint8_t MB_WRITE_SINGLE_REGISTER = 0x06;
+static const uint8_t MB_WRITE_MULTIPLE_COILS = 0x0F;
+static const uint8_t MB_WRITE_MULTIPLE_REGISTERS = 0x10;
+static const uint8_t MB_MASK_WRITE_REGISTER = 0x16;
+static const uint8_t MB_READ_WRITE_MULTIPLE_REGISTERS = 0x17;
+
+RtuFrameAssembler::RtuFrameAssembler() :
+	head(0), tail(0), armed(false), slave(0), function(0),
+	index(0), expected(0), crc(0xFFFF), gapUs(0),
+	crcErrors(0), discardedBytes(0), gapErrors(0)
+{
+}
+
+/* Prepare for the response to a request that is about to be sent.
+ * Bytes that arrive while the assembler is not armed are dropped.
+ */
+void RtuFrameAssembler::arm(uint8_t slave, uint8_t function)
+{
+	armed = false;
+	this->slave = slave;
+	this->function = function;
+	restart();
+	armed = true;
+}
+
+void RtuFrameAssembler::restart()
+{
+	index = 0;
+	expected = 0;
+	crc = 0xFFFF;
+}
+
+void RtuFrameAssembler::disarm()
+{
+	armed = false;
+}
+
+void RtuFrameAssembler::reject()
+{
+	discardedBytes += index;
+	armed = false;
+}
+
+void RtuFrameAssembler::silence()
+{
+	if(armed && index > 0) {
+		discardedBytes += index;
+		gapErrors++;
+		restart();
+	}
+}
+
+void RtuFrameAssembler::put(uint8_t byte)
+{
+	if(!armed || (uint8_t)(head - tail) >= QUEUE_SIZE) {
+		discardedBytes++;
+		return;
+	}
+
+	RtuFrame &frame = frames[head & (QUEUE_SIZE - 1)];
+	frame.data[index++] = byte;
+	crc = crc16_update(crc, byte);
+
+	switch(index) {
+	case 1:
+		if(byte != slave) reject();
+		break;
+	case 2:
+		if((byte & 0x7F) != function) {
+			reject();
+		}
+		else if(byte & 0x80) {
+			expected = 5;	// exception response: id, function, code, CRC
+		}
+		else {
+			switch(function) {
+			case MB_READ_COILS:
+			case MB_READ_DISCRETE_INPUTS:
+			case MB_READ_HOLDING_REGISTERS:
+			case MB_READ_INPUT_REGISTERS:
+			case MB_READ_WRITE_MULTIPLE_REGISTERS:
+				break;		// length follows in the byte count field
+			case MB_WRITE_SINGLE_COIL:
+			case MB_WRITE_SINGLE_REGISTER:
+			case MB_WRITE_MULTIPLE_COILS:
+			case MB_WRITE_MULTIPLE_REGISTERS:
+				expected = 8;
+				break;
+			case MB_MASK_WRITE_REGISTER:
+				expected = 10;
+				break;
+			default:
+				reject();
+				break;
+			}
+		}
+		break;
+	case 3:
+		if(expected == 0) {
+			expected = byte + 5;	// id, function, byte count, data, CRC
+			if(expected > sizeof(frame.data)) reject();
+		}
+		break;
+	}
+
+	if(armed && index == expected) {
+		// the CRC of a frame including its own CRC field is zero
+		if(crc == 0) {
+			frame.size = index;
+			head++;
+		}
+		else {
+			crcErrors++;
+		}
+		armed = false;
+	}
+}
+
+const RtuFrame *RtuFrameAssembler::peekFrame()
+{
+	if(head == tail) return NULL;
+	return &frames[tail & (QUEUE_SIZE - 1)];
+}
+
+void RtuFrameAssembler::releaseFrame()
+{
+	if(head != tail) tail++;
+}
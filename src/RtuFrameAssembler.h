@@ -0,0 +1,62 @@
+/*
+ * RtuFrameAssembler.h
+ *
+ *  Created on: 19.10.2026
+ *
+ * Incremental Modbus RTU response assembler. The UART interrupt feeds the
+ * received bytes one at a time; the CRC is updated as the bytes arrive and
+ * the frame length is derived from the function code of the pending request.
+ * Only complete frames with a valid CRC are posted to the frame queue, so the
+ * main loop never touches corrupted responses.
+ *
+ * A silence longer than t3.5 ends an RTU frame. The serial port times it
+ * with a software timer and calls silence(); if that happens in the middle
+ * of a response, the partial frame is dropped and the byte after the gap is
+ * taken as the start of a new frame.
+ */
+
+#ifndef RTUFRAMEASSEMBLER_H_
+#define RTUFRAMEASSEMBLER_H_
+
+#include <stdint.h>
+
+struct RtuFrame {
+	uint16_t size;
+	uint8_t data[256];
+};
+
+class RtuFrameAssembler {
+public:
+	RtuFrameAssembler();
+	void arm(uint8_t slave, uint8_t function);
+	void disarm();
+	void setGapTimeout(uint32_t us) { gapUs = us; }	// t3.5, 0 disables the check
+	uint32_t getGapTimeout() const { return gapUs; }
+	void put(uint8_t byte);		// called from the UART ISR
+	void silence();				// t3.5 elapsed since the last byte, UART interrupt masked
+	const RtuFrame *peekFrame();		// oldest validated frame or NULL
+	void releaseFrame();
+	uint32_t getCrcErrors() const { return crcErrors; }
+	uint32_t getDiscardedBytes() const { return discardedBytes; }
+	uint32_t getGapErrors() const { return gapErrors; }
+private:
+	static const uint8_t QUEUE_SIZE = 2;	// must be a power of two
+	void reject();
+	void restart();
+
+	RtuFrame frames[QUEUE_SIZE];
+	volatile uint8_t head;		// written by ISR only
+	volatile uint8_t tail;		// written by main loop only
+	volatile bool armed;
+	uint8_t slave;
+	uint8_t function;
+	uint16_t index;
+	uint16_t expected;
+	uint16_t crc;
+	uint32_t gapUs;
+	volatile uint32_t crcErrors;
+	volatile uint32_t discardedBytes;
+	volatile uint32_t gapErrors;		// frames broken by a silence longer than t3.5
+};
+
+#endif /* RTUFRAMEASSEMBLER_H_ */
@@ -0,0 +1,97 @@
+/*
+ * SensorSampler.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "SensorSampler.h"
+#include "Trace.h"
+
+/* provided by the application, see ModbusMaster.h */
+uint32_t millis();
+
+static void samplerTick(void *context) {
+	static_cast<SensorSampler *>(context)->tick();
+}
+
+SensorSampler::SensorSampler(PressureSensor &sensor, I2C &i2c, uint32_t rateHz) :
+	sensor(sensor), i2c(i2c), timer(samplerTick, this), rateHz(clampRate(rateHz)), lastTime(0), valid(false),
+	overruns(0), dropped(0), errors(0) {
+}
+
+SensorSampler::~SensorSampler() {
+	stop();
+}
+
+void SensorSampler::start() {
+	rateHz = clampRate(rateHz);		// the resolution may have changed
+	timer.startPeriodic(1000000 / rateHz);
+}
+
+void SensorSampler::stop() {
+	timer.stop();
+}
+
+/* A tick while the previous read is still converting is an overrun, so
+ * a faster rate would only skip every other tick. */
+uint32_t SensorSampler::clampRate(uint32_t rateHz) const {
+	uint32_t maxRate = 1000000 / sensor.readTimeUs();
+
+	if(maxRate > MAX_RATE) maxRate = MAX_RATE;
+	if(rateHz > maxRate) rateHz = maxRate;
+	if(rateHz < MIN_RATE) rateHz = MIN_RATE;
+	return rateHz;
+}
+
+void SensorSampler::setRate(uint32_t rateHz) {
+	this->rateHz = clampRate(rateHz);
+	if(timer.isActive()) timer.startPeriodic(1000000 / rateHz);
+}
+
+/* Timer interrupt: supervise the bus and start the next read. If the
+ * previous read has not completed yet the tick is skipped and counted,
+ * which keeps the sample period fixed instead of letting it drift.
+ */
+void SensorSampler::tick() {
+	i2c.poll();
+	if(!sensor.startRead(onSample, this)) overruns++;
+}
+
+void SensorSampler::onSample(void *context, PressureSensor::Status status, const PressureSensor::Sample &sample) {
+	SensorSampler *sampler = static_cast<SensorSampler *>(context);
+
+	traceEvent(TRACE_SENSOR, TRACE_SENSOR_SAMPLE, sample.pascal, status);
+	if(status != PressureSensor::OK) {
+		sampler->errors++;
+		return;
+	}
+	TimedSample timed = { millis(), sample.pascal };
+	if(!sampler->ring.push(timed)) sampler->dropped++;
+	sampler->lastTime = timed.time;
+	sampler->valid = true;
+}
+
+bool SensorSampler::pop(TimedSample &sample) {
+	return ring.pop(sample);
+}
+
+/* Average of all samples taken since the previous call (oversampling).
+ * Returns false without waiting if there is no new sample.
+ */
+bool SensorSampler::collect(int32_t &pascal) {
+	TimedSample sample;
+	int64_t sum = 0;
+	int32_t n = 0;
+
+	while(ring.pop(sample)) {
+		sum += sample.pascal;
+		n++;
+	}
+	if(n == 0) return false;
+	pascal = (int32_t)(sum / n);
+	return true;
+}
+
+bool SensorSampler::isStale(uint32_t maxAgeMs) const {
+	return !valid || (millis() - lastTime) > maxAgeMs;
+}
@@ -0,0 +1,64 @@
+/*
+ * SensorSampler.h
+ *
+ *  Created on: 19.10.2026
+ *
+ * Fixed-rate pressure sampling. A periodic software timer triggers an asynchronous sensor read
+ * at a configurable rate; validated samples are time-stamped in the I2C
+ * completion interrupt and pushed into a lock-free ring. The control loop
+ * collects them without waiting and may average several samples per cycle.
+ *
+ * The rate is limited to what the sensor can deliver at its resolution
+ * (about 190 Hz at the default 12 bits). start() and setRate() apply the
+ * limit for the sensor's current resolution.
+ */
+
+#ifndef SENSORSAMPLER_H_
+#define SENSORSAMPLER_H_
+
+#include "chip.h"
+#include "I2C.h"
+#include "PressureSensor.h"
+#include "SpscRing.h"
+#include "TimerService.h"
+
+class SensorSampler {
+public:
+	struct TimedSample {
+		uint32_t time;		// millis() when the read completed
+		int32_t pascal;		// Q16.16
+	};
+
+	SensorSampler(PressureSensor &sensor, I2C &i2c, uint32_t rateHz = 100);
+	virtual ~SensorSampler();
+	void start();
+	void stop();
+	void setRate(uint32_t rateHz);
+	uint32_t getRate() const { return rateHz; }
+	bool pop(TimedSample &sample);
+	bool collect(int32_t &pascal);
+	bool isStale(uint32_t maxAgeMs) const;
+	uint32_t getOverruns() const { return overruns; }
+	uint32_t getDropped() const { return dropped; }
+	uint32_t getErrors() const { return errors; }
+	void tick();
+private:
+	uint32_t clampRate(uint32_t rateHz) const;
+	static void onSample(void *context, PressureSensor::Status status, const PressureSensor::Sample &sample);
+
+	static const uint32_t MIN_RATE = 5;
+	static const uint32_t MAX_RATE = 1000;
+
+	PressureSensor &sensor;
+	I2C &i2c;
+	SoftTimer timer;
+	uint32_t rateHz;
+	SpscRing<TimedSample, 32> ring;
+	volatile uint32_t lastTime;
+	volatile bool valid;		// at least one sample has been taken
+	volatile uint32_t overruns;	// tick while the previous read was still pending
+	volatile uint32_t dropped;	// ring full
+	volatile uint32_t errors;	// failed reads (I2C or CRC)
+};
+
+#endif /* SENSORSAMPLER_H_ */
@@ -5,6 +5,8 @@
  *      Author: krl
  */
 #include "SerialPort.h"
+#include "Profiler.h"
+#include "TimerService.h"
 
 
 #define LPC_USART       LPC_USART1
@@ -17,6 +19,35 @@
 
 static RINGBUFF_T *rxring1;
 static RINGBUFF_T *txring1;
+static RtuFrameAssembler * volatile assembler1 = NULL;
+static volatile SerialPort::LineStats *lineStats1;
+
+/* provided by the application, see ModbusMaster.h */
+uint32_t millis();
+
+/* t3.5 timer, restarted by every received byte in frame mode. The UART
+   interrupt preempts the timer callback, so a byte may arrive after the
+   timer expired but before the callback runs; it restarts the timer, which
+   tells the callback that the line was not silent after all. */
+static void gapExpired(void *context)
+{
+	NVIC_DisableIRQ(LPC_IRQNUM);
+	if (assembler1 != NULL && !static_cast<SoftTimer *>(context)->isActive()) {
+		assembler1->silence();
+	}
+	NVIC_EnableIRQ(LPC_IRQNUM);
+}
+
+static SoftTimer gapTimer(gapExpired, &gapTimer);
+
+#define UART_LINE_ERRORS (UART_STAT_OVERRUNINT | UART_STAT_FRM_ERRINT | UART_STAT_PAR_ERRINT | \
+		UART_STAT_RXNOISEINT | UART_STAT_DELTARXBRK)
+
+static inline void recordLineEvent(SerialPort::LineEvent event, uint32_t now)
+{
+	lineStats1->count[event]++;
+	lineStats1->lastTime[event] = now;
+}
 
 extern "C" {
 /**
@@ -25,11 +56,45 @@ extern "C" {
  */
 void LPC_UARTHNDLR(void)
 {
-	/* Want to handle any errors? Do it here. */
-
-	/* Use default ring buffer handler. Override this with your own
-	   code if you need more capability. */
-	Chip_UART_IRQRBHandler(LPC_USART, rxring1, txring1);
+	PROFILE_ZONE(PROFILE_UART_ISR);
+	uint32_t status = Chip_UART_GetStatus(LPC_USART);
+
+	/* Count line errors and clear their sticky status bits. A byte that
+	   arrives with a framing/parity/noise error is still delivered below
+	   and will normally be caught by the Modbus CRC. */
+	if (status & UART_LINE_ERRORS) {
+		uint32_t now = millis();
+		if (status & UART_STAT_OVERRUNINT) recordLineEvent(SerialPort::OVERRUN, now);
+		if (status & UART_STAT_FRM_ERRINT) recordLineEvent(SerialPort::FRAMING, now);
+		if (status & UART_STAT_PAR_ERRINT) recordLineEvent(SerialPort::PARITY, now);
+		if (status & UART_STAT_RXNOISEINT) recordLineEvent(SerialPort::NOISE, now);
+		// count the start of a break only, not its end
+		if ((status & UART_STAT_DELTARXBRK) && (status & UART_STAT_RXBRK)) recordLineEvent(SerialPort::BREAK, now);
+		Chip_UART_ClearStatus(LPC_USART, status & UART_LINE_ERRORS);
+	}
+
+	/* Transmit as in the default ring buffer handler */
+	if ((status & UART_STAT_TXRDY) != 0) {
+		Chip_UART_TXIntHandlerRB(LPC_USART, txring1);
+		if (RingBuffer_IsEmpty(txring1)) {
+			Chip_UART_IntDisable(LPC_USART, UART_INTEN_TXRDY);
+		}
+	}
+
+	/* In frame mode received bytes go to the frame assembler, otherwise to
+	   the receive ring buffer. Bytes that do not fit in the ring are counted
+	   instead of vanishing silently. */
+	while ((Chip_UART_GetStatus(LPC_USART) & UART_STAT_RXRDY) != 0) {
+		uint8_t ch = Chip_UART_ReadByte(LPC_USART);
+		RtuFrameAssembler *assembler = assembler1;
+		if (assembler != NULL) {
+			assembler->put(ch);
+			if (assembler->getGapTimeout() != 0) gapTimer.start(assembler->getGapTimeout());
+		}
+		else if (!RingBuffer_Insert(rxring1, &ch)) {
+			recordLineEvent(SerialPort::RING_FULL, millis());
+		}
+	}
 }
 
 }
@@ -82,9 +147,12 @@ SerialPort::SerialPort() {
 	 */
 	rxring1 = &rxring;
 	txring1 = &txring;
+	lineStats1 = &lineStats;
+	clearLineStats();
 
 	/* Enable receive data and line status interrupt */
-	Chip_UART_IntEnable(LPC_USART, UART_INTEN_RXRDY);
+	Chip_UART_IntEnable(LPC_USART, UART_INTEN_RXRDY | UART_INTEN_OVERRUN | UART_INTEN_FRAMERR |
+			UART_INTEN_PARITYERR | UART_INTEN_RXNOISE | UART_INTEN_DELTARXBRK);
 	Chip_UART_IntDisable(LPC_USART, UART_INTEN_TXRDY);	/* May not be needed */
 
 	/* Enable UART interrupt */
@@ -127,3 +195,29 @@ int SerialPort::print(int val, int format) {
 void SerialPort::flush() {
 	while(RingBuffer_GetCount(&txring)>0) __WFI();
 }
+
+/* Route received bytes to an RTU frame assembler (frame mode) or,
+ * with NULL, back to the receive ring buffer.
+ */
+void SerialPort::setFrameAssembler(RtuFrameAssembler *assembler) {
+	assembler1 = assembler;
+}
+
+/* Snapshot of the line error counters. Each counter is read atomically; the
+ * set as a whole may straddle an interrupt, which is fine for diagnostics.
+ */
+void SerialPort::getLineStats(LineStats &stats) {
+	for(int i = 0; i < LINE_EVENT_COUNT; i++) {
+		stats.count[i] = lineStats.count[i];
+		stats.lastTime[i] = lineStats.lastTime[i];
+	}
+}
+
+void SerialPort::clearLineStats() {
+	NVIC_DisableIRQ(LPC_IRQNUM);
+	for(int i = 0; i < LINE_EVENT_COUNT; i++) {
+		lineStats.count[i] = 0;
+		lineStats.lastTime[i] = 0;
+	}
+	NVIC_EnableIRQ(LPC_IRQNUM);
+}
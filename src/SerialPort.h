@@ -16,9 +16,17 @@
 #endif
 #endif
 
+#include "RtuFrameAssembler.h"
 
 class SerialPort {
 public:
+	/* Receive problems recorded by the UART ISR */
+	enum LineEvent { OVERRUN, FRAMING, PARITY, NOISE, BREAK, RING_FULL, LINE_EVENT_COUNT };
+	struct LineStats {
+		uint32_t count[LINE_EVENT_COUNT];	// number of events of each kind
+		uint32_t lastTime[LINE_EVENT_COUNT];	// millis() of the latest event of each kind
+	};
+
 	SerialPort();
 	virtual ~SerialPort();
 	int available();
@@ -27,6 +35,9 @@ public:
 	int write(const char* buf, int len);
 	int print(int val, int format);
 	void flush();
+	void setFrameAssembler(RtuFrameAssembler *assembler);
+	void getLineStats(LineStats &stats);
+	void clearLineStats();
 private:
 	static const int UART_RB_SIZE = 128;
 	/* Transmit and receive ring buffers */
@@ -34,6 +45,7 @@ private:
 	RINGBUFF_T rxring;
 	uint8_t rxbuff[UART_RB_SIZE];
 	uint8_t txbuff[UART_RB_SIZE];
+	volatile LineStats lineStats;
 
 
 };
@@ -0,0 +1,94 @@
+/*
+ * SetpointRamp.h
+ *
+ *  Created on: 19.10.2026
+ *
+ * Rate- and acceleration-limited setpoint generator between the controller
+ * output and the drive reference. With only a rate limit the output moves
+ * towards the target on a straight ramp; with an acceleration limit as
+ * well the ramp gets rounded S-shaped ends: the velocity is built up and
+ * taken down gradually, and braking starts early enough to reach the
+ * target without overshoot (v <= sqrt(2 a |error|)).
+ * Rates are per second, time steps in ms. No hardware dependencies.
+ */
+
+#ifndef SETPOINTRAMP_H_
+#define SETPOINTRAMP_H_
+
+#include <stdint.h>
+#include "FixedPoint.h"
+
+template <int F = 16>
+class SetpointRamp {
+public:
+	typedef Fixed<F> Num;
+
+	/* rate in units/s; accel in units/s^2, zero for a plain linear ramp */
+	SetpointRamp(Num rate, Num accel = Num()) : rate(rate), accel(accel) {}
+
+	void setLimits(Num rate, Num accel = Num()) { this->rate = rate; this->accel = accel; }
+
+	/* jump to value, e.g. to follow a manual speed without ramping */
+	void reset(Num value) { out = value; velocity = Num(); }
+
+	Num update(Num target, uint32_t dtMs) {
+		Num error = target - out;
+		Num vMax = rate;
+		Num vWanted, step;
+
+		if(dtMs == 0) return out;
+		if(accel > Num()) {
+			// fastest speed from which the target can still be reached by braking;
+			// the product is taken in 64 bits, it does not fit a Num for long steps
+			Num vStop = sqrt((uint64_t)accel.toRaw() * 2 * abs(error).toRaw());
+			if(vStop < vMax) vMax = vStop;
+		}
+		vWanted = error < Num() ? -vMax : vMax;
+		if(accel > Num()) {
+			Num dv = accel * (int32_t)dtMs / 1000;
+			if(vWanted > velocity + dv) vWanted = velocity + dv;
+			else if(vWanted < velocity - dv) vWanted = velocity - dv;
+		}
+		velocity = vWanted;
+
+		step = velocity * (int32_t)dtMs / 1000;
+		if(abs(step) >= abs(error)) {
+			// arrived: snap to the target and stop
+			out = target;
+			velocity = Num();
+		}
+		else out += step;
+		return out;
+	}
+
+	Num output() const { return out; }
+	Num getVelocity() const { return velocity; }
+	bool isSettled(Num target) const { return out == target && velocity == Num(); }
+
+private:
+	static Num abs(Num v) { return v < Num() ? -v : v; }
+
+	/* bitwise integer square root of a value with 2F fractional bits */
+	static Num sqrt(uint64_t x) {
+		uint64_t result = 0;
+		uint64_t bit = 1ULL << 62;
+
+		while(bit > x) bit >>= 2;
+		while(bit != 0) {
+			if(x >= result + bit) {
+				x -= result + bit;
+				result = (result >> 1) + bit;
+			}
+			else result >>= 1;
+			bit >>= 2;
+		}
+		if(result > 0x7FFFFFFF) return Num::max();
+		return Num::fromRaw((int32_t)result);
+	}
+
+	Num rate, accel;
+	Num out;
+	Num velocity;
+};
+
+#endif /* SETPOINTRAMP_H_ */
@@ -0,0 +1,51 @@
+/*
+ * SpscRing.h
+ *
+ *  Created on: 19.10.2026
+ *
+ * Lock-free single-producer single-consumer ring buffer. One side (typically
+ * an interrupt handler) pushes, the other pops; neither needs to disable
+ * interrupts. N must be a power of two.
+ */
+
+#ifndef SPSCRING_H_
+#define SPSCRING_H_
+
+template <typename T, unsigned N>
+class SpscRing {
+	static_assert(N > 0 && (N & (N - 1)) == 0, "SpscRing size must be a power of two");
+public:
+	SpscRing() : head(0), tail(0) {}
+
+	/* producer side; returns false (and drops the item) when full */
+	bool push(const T &item) {
+		unsigned h = head;
+		if(h - tail == N) return false;
+		buf[h & (N - 1)] = item;
+		barrier();		// item must be stored before it is published
+		head = h + 1;
+		return true;
+	}
+
+	/* consumer side; returns false when empty */
+	bool pop(T &item) {
+		unsigned t = tail;
+		if(head == t) return false;
+		item = buf[t & (N - 1)];
+		barrier();		// item must be read before the slot is released
+		tail = t + 1;
+		return true;
+	}
+
+	unsigned count() const { return head - tail; }
+	bool empty() const { return head == tail; }
+
+private:
+	static inline void barrier() { __asm volatile ("" ::: "memory"); }
+
+	T buf[N];
+	volatile unsigned head;
+	volatile unsigned tail;
+};
+
+#endif /* SPSCRING_H_ */
@@ -0,0 +1,77 @@
+/*
+ * StreamingMedian.h
+ *
+ *  Created on: 19.10.2026
+ *
+ * Running median over the last N samples without any allocation. The window
+ * is kept both in arrival order (to know which sample to evict) and sorted.
+ * An update finds the evicted sample by binary search and slides the new one
+ * into place, so at most the elements between the old and the new position
+ * move; for a stable signal that is O(1).
+ */
+
+#ifndef STREAMINGMEDIAN_H_
+#define STREAMINGMEDIAN_H_
+
+template <typename T, unsigned N>
+class StreamingMedian {
+	static_assert(N > 0, "StreamingMedian needs a window of at least one sample");
+public:
+	StreamingMedian() : count(0), next(0) {}
+
+	/* Add a sample and return the median of the (possibly still filling) window */
+	T update(T value) {
+		unsigned pos;
+
+		if(count < N) {
+			// window still filling: plain insertion
+			pos = count++;
+			while(pos > 0 && value < sorted[pos - 1]) {
+				sorted[pos] = sorted[pos - 1];
+				pos--;
+			}
+		}
+		else {
+			// the oldest sample's slot is reused for the new one; it is in
+			// the window, so if it is not among the first N - 1 it is last
+			pos = lowerBound(window[next], N - 1);
+			while(pos + 1 < N && sorted[pos + 1] < value) {
+				sorted[pos] = sorted[pos + 1];
+				pos++;
+			}
+			while(pos > 0 && value < sorted[pos - 1]) {
+				sorted[pos] = sorted[pos - 1];
+				pos--;
+			}
+		}
+		sorted[pos] = value;
+		window[next] = value;
+		if(++next == N) next = 0;
+
+		return median();
+	}
+
+	/* Median of the current window; for an even count the upper one. */
+	T median() const { return count ? sorted[count / 2] : T(); }
+	unsigned size() const { return count; }
+	bool full() const { return count == N; }
+	void reset() { count = 0; next = 0; }
+
+private:
+	unsigned lowerBound(T value, unsigned hi) const {
+		unsigned lo = 0;
+		while(lo < hi) {
+			unsigned mid = (lo + hi) / 2;
+			if(sorted[mid] < value) lo = mid + 1;
+			else hi = mid;
+		}
+		return lo;
+	}
+
+	T window[N];	// arrival order, next is the oldest once full
+	T sorted[N];
+	unsigned count;
+	unsigned next;
+};
+
+#endif /* STREAMINGMEDIAN_H_ */
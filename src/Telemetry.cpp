@@ -0,0 +1,139 @@
+/*
+ * Telemetry.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "Telemetry.h"
+#include "chip.h"
+#include "crc16.h"
+#include "Clock.h"
+
+#define TELEMETRY_USART		LPC_USART0
+#define TELEMETRY_IRQNUM	UART0_IRQn
+#define TELEMETRY_HNDLR		UART0_IRQHandler
+
+/* room for about 13 frames, 40 ms of UART time at 115200 baud */
+static const int TX_RING_SIZE = 512;
+
+static RINGBUFF_T txring;
+static uint8_t txbuff[TX_RING_SIZE];
+
+extern "C" {
+/**
+ * @brief	Board UART interrupt handler, transmit only
+ * @return	Nothing
+ */
+void TELEMETRY_HNDLR(void)
+{
+	Chip_UART_TXIntHandlerRB(TELEMETRY_USART, &txring);
+	if (RingBuffer_IsEmpty(&txring)) {
+		Chip_UART_IntDisable(TELEMETRY_USART, UART_INTEN_TXRDY);
+	}
+}
+}
+
+static inline uint8_t *put8(uint8_t *p, uint8_t v) {
+	*p++ = v;
+	return p;
+}
+
+static inline uint8_t *put16(uint8_t *p, uint16_t v) {
+	p = put8(p, v);
+	return put8(p, v >> 8);
+}
+
+static inline uint8_t *put32(uint8_t *p, uint32_t v) {
+	p = put16(p, v);
+	return put16(p, v >> 16);
+}
+
+Telemetry::Telemetry(uint32_t controlRateHz, uint32_t rateHz) :
+	controlRateHz(controlRateHz), count(0), sequence(0), sent(0), dropped(0) {
+	setRate(rateHz);
+}
+
+/* The board UART is set up by Board_Init(); only its transmitter moves to
+ * the ring. Board_UARTGetChar() keeps polling the receiver. */
+void Telemetry::begin() {
+	RingBuffer_Init(&txring, txbuff, 1, TX_RING_SIZE);
+	Chip_UART_IntDisable(TELEMETRY_USART, UART_INTEN_TXRDY);
+	NVIC_EnableIRQ(TELEMETRY_IRQNUM);
+}
+
+/* The rate is rounded to a whole divider of the control rate. */
+void Telemetry::setRate(uint32_t rateHz) {
+	if(rateHz > controlRateHz) rateHz = controlRateHz;
+	divider = rateHz != 0 ? (controlRateHz + rateHz / 2) / rateHz : 0;
+	this->rateHz = divider != 0 ? controlRateHz / divider : 0;
+	count = 0;
+}
+
+bool Telemetry::due() {
+	if(divider == 0) return false;
+	if(++count < divider) return false;
+	count = 0;
+	return true;
+}
+
+/* Consistent overhead byte stuffing: every zero is replaced by the
+ * distance to the next one, so the frame contains no zero but the final
+ * delimiter. Returns the encoded length including the delimiter.
+ */
+int Telemetry::encode(const uint8_t *in, int length, uint8_t *out) {
+	uint8_t *code = out;	// where the current block's distance goes
+	uint8_t *p = out + 1;
+	uint8_t distance = 1;
+
+	for(int i = 0; i < length; i++) {
+		if(in[i] != 0) {
+			*p++ = in[i];
+			distance++;
+		}
+		if(in[i] == 0 || distance == 0xFF) {
+			*code = distance;
+			code = p++;
+			distance = 1;
+		}
+	}
+	*code = distance;
+	*p++ = 0;
+	return p - out;
+}
+
+/* Called from the control step; never waits. */
+bool Telemetry::send(const TelemetrySample &sample) {
+	uint8_t payload[PAYLOAD_SIZE];
+	uint8_t frame[FRAME_SIZE];
+	uint8_t *p = payload;
+	uint16_t crc = 0xFFFF;
+	int length;
+
+	p = put8(p, FRAME_SAMPLE);
+	p = put16(p, sequence++);
+	p = put32(p, micros());
+	p = put8(p, sample.setpoint);
+	p = put8(p, sample.filtered);
+	p = put32(p, sample.pascal);
+	p = put32(p, sample.pTerm.toRaw());
+	p = put32(p, sample.iTerm.toRaw());
+	p = put32(p, sample.dTerm.toRaw());
+	p = put8(p, sample.output);
+	p = put8(p, sample.speed);
+	p = put8(p, sample.modbusStatus);
+	p = put16(p, sample.modbusTransactions);
+	p = put16(p, sample.modbusErrors);
+	p = put8(p, sample.flags);
+	for(uint8_t *q = payload; q < p; q++) crc = crc16_update(crc, *q);
+	p = put16(p, crc);
+
+	length = encode(payload, p - payload, frame);
+	// all or nothing, a partial frame would corrupt the next one as well
+	if(RingBuffer_GetFree(&txring) < length) {
+		dropped++;
+		return false;
+	}
+	Chip_UART_SendRB(TELEMETRY_USART, &txring, frame, length);
+	sent++;
+	return true;
+}
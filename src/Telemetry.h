@@ -0,0 +1,72 @@
+/*
+ * Telemetry.h
+ *
+ *  Created on: 19.10.2026
+ *
+ * Binary control-loop telemetry on the board UART (USART0, 115200 baud).
+ * Every frame is COBS encoded and ends in a zero byte, so a receiver that
+ * starts mid-stream synchronizes on the next zero. Decoded, a frame is
+ *     type, sequence (u16), timestamp (u32, micros()),
+ *     setpoint, filtered pressure (u8, Pa), pressure (i32, Q16 Pa),
+ *     P, I, D terms (i32, Q16 %), controller output, fan speed (u8, %),
+ *     Modbus status (u8), Modbus transactions and errors (u16, cumulative,
+ *     wrapping), flags (u8), CRC-16/Modbus of all previous bytes
+ * in little-endian byte order. tools/telemetry.py reads the stream.
+ *
+ * send() queues the frame in a transmit ring that the USART0 interrupt
+ * drains, so it never waits for the UART. A frame that does not fit is
+ * dropped whole; its sequence number is used anyway, so the receiver can
+ * count the gaps.
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdint.h>
+#include "FixedPoint.h"
+
+struct TelemetrySample {
+	uint8_t setpoint;		// Pa
+	uint8_t filtered;		// Pa, median filtered
+	int32_t pascal;			// sensor average, Q16
+	Q16 pTerm, iTerm, dTerm;
+	uint8_t output;			// controller output, %
+	uint8_t speed;			// ramped fan speed, %
+	uint8_t modbusStatus;	// result of the latest drive transaction
+	uint16_t modbusTransactions;	// drive transactions so far, wrapping
+	uint16_t modbusErrors;			// failed ones
+	uint8_t flags;
+};
+
+class Telemetry {
+public:
+	static const uint8_t FLAG_AUTOMATIC = 0x01;
+	static const uint8_t FLAG_TUNING = 0x02;
+	static const uint8_t FLAG_SWEEPING = 0x04;
+	static const uint8_t FLAG_FRESH = 0x08;		// new sensor sample in this step
+
+	Telemetry(uint32_t controlRateHz, uint32_t rateHz);
+	void begin();
+	void setRate(uint32_t rateHz);	// 0 stops, at most the control rate
+	uint32_t getRate() const { return rateHz; }
+	bool due();				// once per control step, true when a sample is to be sent
+	bool send(const TelemetrySample &sample);
+	uint32_t getSent() const { return sent; }
+	uint32_t getDropped() const { return dropped; }
+private:
+	static const uint8_t FRAME_SAMPLE = 1;
+	static const int PAYLOAD_SIZE = 35;
+	static const int FRAME_SIZE = PAYLOAD_SIZE + PAYLOAD_SIZE / 254 + 2;	// COBS overhead and delimiter
+
+	static int encode(const uint8_t *in, int length, uint8_t *out);
+
+	uint32_t controlRateHz;
+	uint32_t rateHz;
+	uint32_t divider;		// control steps per sample
+	uint32_t count;
+	uint16_t sequence;
+	uint32_t sent;
+	uint32_t dropped;
+};
+
+#endif /* TELEMETRY_H_ */
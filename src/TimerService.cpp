@@ -0,0 +1,173 @@
+/*
+ * TimerService.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "TimerService.h"
+
+bool TimerService::initialized = false;
+uint32_t TimerService::tickRate = 0;
+SoftTimer *TimerService::head = NULL;
+
+static const uint64_t RIT_MAX = 0xFFFFFFFFFFFFULL;	// 48-bit counter
+
+/* short critical sections shared with every interrupt that may start or
+ * stop a timer */
+static inline uint32_t enterCritical() {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	return primask;
+}
+
+static inline void exitCritical(uint32_t primask) {
+	__set_PRIMASK(primask);
+}
+
+extern "C" {
+/**
+ * @brief	RIT interrupt handler, runs the expired software timers
+ * @return	Nothing
+ */
+void RIT_IRQHandler(void)
+{
+	TimerService::isr();
+}
+}
+
+/* The tick rate follows SystemCoreClock, so call SystemCoreClockUpdate()
+ * first. Timers initialize the service on first use with priority 1.
+ */
+void TimerService::init(uint32_t priority) {
+	if(!initialized) {
+		Chip_RIT_Init(LPC_RITIMER);
+		Chip_RIT_DisableCompClear(LPC_RITIMER);	// free running
+		Chip_RIT_SetCompareValue(LPC_RITIMER, RIT_MAX);
+		Chip_RIT_SetCounter(LPC_RITIMER, 0);
+		tickRate = SystemCoreClock / 1000000;
+		initialized = true;
+		Chip_RIT_Enable(LPC_RITIMER);
+	}
+	NVIC_SetPriority(RITIMER_IRQn, priority);
+	NVIC_EnableIRQ(RITIMER_IRQn);
+}
+
+/* COUNTER and COUNTER_H are read separately (as Chip_RIT_GetCounter()
+ * does), so a read across the low word's wrap would come out 2^32 ticks
+ * early and program() would miss a deadline that has already passed.
+ * Retry until the high word is the same on both sides of the low one.
+ */
+uint64_t TimerService::now() {
+	uint32_t high, low;
+
+	do {
+		high = LPC_RITIMER->COUNTER_H;
+		low = LPC_RITIMER->COUNTER;
+	} while(high != LPC_RITIMER->COUNTER_H);
+	return ((uint64_t)high << 32) | low;
+}
+
+/* Busy-wait on the RIT counter; timers keep running meanwhile. */
+void TimerService::delayUs(uint32_t us) {
+	if(!initialized) init();
+	uint64_t end = now() + (uint64_t)us * tickRate;
+	while(now() < end) {
+	}
+}
+
+/* callers hold the critical section */
+void TimerService::insert(SoftTimer *timer) {
+	SoftTimer **p = &head;
+
+	while(*p != NULL && (*p)->deadline <= timer->deadline) p = &(*p)->next;
+	timer->next = *p;
+	*p = timer;
+	timer->active = true;
+}
+
+void TimerService::remove(SoftTimer *timer) {
+	for(SoftTimer **p = &head; *p != NULL; p = &(*p)->next) {
+		if(*p == timer) {
+			*p = timer->next;
+			break;
+		}
+	}
+	timer->active = false;
+}
+
+/* The RIT compares for equality, so a deadline that has already passed
+ * would never match; pend the interrupt instead and let isr() catch up.
+ */
+void TimerService::program() {
+	uint64_t deadline = head != NULL ? head->deadline : RIT_MAX;
+
+	Chip_RIT_SetCompareValue(LPC_RITIMER, deadline);
+	if(head != NULL && now() >= deadline) NVIC_SetPendingIRQ(RITIMER_IRQn);
+}
+
+/* A periodic timer keeps its phase. If its callback or a higher priority
+ * interrupt made it miss periods, those are skipped rather than run in a
+ * burst.
+ */
+void TimerService::isr() {
+	Chip_RIT_ClearIntStatus(LPC_RITIMER);
+	for(;;) {
+		uint32_t primask = enterCritical();
+		SoftTimer *timer = head;
+		uint64_t time = now();
+
+		if(timer == NULL || timer->deadline > time) {
+			program();
+			exitCritical(primask);
+			return;
+		}
+		remove(timer);
+		if(timer->period != 0) {
+			do {
+				timer->deadline += timer->period;
+			} while(timer->deadline <= time);
+			insert(timer);
+		}
+		exitCritical(primask);
+		timer->callback(timer->context);
+	}
+}
+
+SoftTimer::SoftTimer(Callback callback, void *context) :
+	callback(callback), context(context), deadline(0), period(0), active(false), next(NULL) {
+}
+
+SoftTimer::~SoftTimer() {
+	stop();
+}
+
+void SoftTimer::start(uint32_t delayUs) {
+	if(!TimerService::initialized) TimerService::init();
+	uint32_t primask = enterCritical();
+	if(active) TimerService::remove(this);
+	period = 0;
+	deadline = TimerService::now() + (uint64_t)delayUs * TimerService::tickRate;
+	TimerService::insert(this);
+	TimerService::program();
+	exitCritical(primask);
+}
+
+void SoftTimer::startPeriodic(uint32_t periodUs) {
+	if(!TimerService::initialized) TimerService::init();
+	uint32_t primask = enterCritical();
+	if(active) TimerService::remove(this);
+	period = periodUs * TimerService::tickRate;
+	deadline = TimerService::now() + period;
+	TimerService::insert(this);
+	TimerService::program();
+	exitCritical(primask);
+}
+
+void SoftTimer::stop() {
+	uint32_t primask = enterCritical();
+	if(active) {
+		TimerService::remove(this);
+		TimerService::program();
+	}
+	exitCritical(primask);
+}
@@ -0,0 +1,61 @@
+/*
+ * TimerService.h
+ *
+ *  Created on: 19.10.2026
+ *
+ * Software timers multiplexed onto the RIT. The RIT counter runs freely
+ * at the system clock; active timers are kept in a list sorted by their
+ * deadline and the compare register is always set to the earliest one,
+ * so there is one interrupt per expiry and none in between.
+ *
+ * Callbacks run in the RIT interrupt (priority set by init()) and must be
+ * short. start() and stop() may be called from any context, including
+ * other interrupts and the callbacks themselves.
+ */
+
+#ifndef TIMERSERVICE_H_
+#define TIMERSERVICE_H_
+
+#include "chip.h"
+
+class SoftTimer {
+public:
+	typedef void (*Callback)(void *context);
+
+	SoftTimer(Callback callback, void *context);
+	virtual ~SoftTimer();
+	void start(uint32_t delayUs);			// one-shot, restarts a running timer
+	void startPeriodic(uint32_t periodUs);	// first expiry one period from now
+	void stop();
+	bool isActive() const { return active; }
+private:
+	friend class TimerService;
+
+	Callback callback;
+	void *context;
+	uint64_t deadline;		// RIT counter value
+	uint32_t period;		// ticks, 0 for one-shot
+	volatile bool active;
+	SoftTimer *next;
+};
+
+class TimerService {
+public:
+	static void init(uint32_t priority = 1);
+	static uint64_t now();
+	static uint32_t ticksPerUs() { return tickRate; }
+	static void delayUs(uint32_t us);
+	static void isr();
+private:
+	friend class SoftTimer;
+
+	static void insert(SoftTimer *timer);
+	static void remove(SoftTimer *timer);
+	static void program();
+
+	static bool initialized;
+	static uint32_t tickRate;
+	static SoftTimer *head;
+};
+
+#endif /* TIMERSERVICE_H_ */
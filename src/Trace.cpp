@@ -0,0 +1,147 @@
+/*
+ * Trace.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include "Trace.h"
+#include "chip.h"
+#include "Clock.h"
+
+static const uint8_t EVENT_SYNC = 0xA5;
+
+/* Byte ring of one stimulus port. Writers hold interrupts off while they
+ * copy an event, so an event is always queued whole; traceFlush() is the
+ * only reader. Sizes are powers of two.
+ */
+struct Channel {
+	uint8_t *buf;
+	uint16_t mask;
+	volatile uint16_t head;
+	volatile uint16_t tail;
+	uint8_t sequence;
+	uint32_t dropped;
+};
+
+/* sized for the default load, see Trace.h */
+static uint8_t textBuf[1024];
+static uint8_t controlBuf[512];		// 420 ms at 1.2 kB/s
+static uint8_t modbusBuf[256];		// 800 ms at 320 B/s
+static uint8_t sensorBuf[1024];		// 640 ms at 1.6 kB/s
+
+static Channel channels[TRACE_CHANNELS] = {
+	{ textBuf, sizeof(textBuf) - 1, 0, 0, 0, 0 },
+	{ controlBuf, sizeof(controlBuf) - 1, 0, 0, 0, 0 },
+	{ modbusBuf, sizeof(modbusBuf) - 1, 0, 0, 0, 0 },
+	{ sensorBuf, sizeof(sensorBuf) - 1, 0, 0, 0, 0 },
+};
+
+static inline uint32_t enterCritical() {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	return primask;
+}
+
+static inline void exitCritical(uint32_t primask) {
+	__set_PRIMASK(primask);
+}
+
+static inline unsigned space(const Channel &c) {
+	return c.mask + 1 - (uint16_t)(c.head - c.tail);
+}
+
+static inline void put(Channel &c, uint8_t byte) {
+	c.buf[c.head & c.mask] = byte;
+	c.head++;
+}
+
+static inline void putWord(Channel &c, uint32_t word) {
+	put(c, word);
+	put(c, word >> 8);
+	put(c, word >> 16);
+	put(c, word >> 24);
+}
+
+bool traceEvent(TraceChannel channel, uint8_t id, const uint32_t *payload, uint8_t words) {
+	Channel &c = channels[channel];
+	uint32_t now = micros();
+	bool queued = false;
+	uint32_t primask;
+
+	if(channel == TRACE_TEXT || words > TRACE_MAX_PAYLOAD) return false;
+	primask = enterCritical();
+	if(space(c) >= 4u * (2 + words)) {
+		putWord(c, EVENT_SYNC | (uint32_t)id << 8 | (uint32_t)words << 16 | (uint32_t)c.sequence << 24);
+		putWord(c, now);
+		for(uint8_t i = 0; i < words; i++) putWord(c, payload[i]);
+		queued = true;
+	}
+	else {
+		c.dropped++;
+	}
+	c.sequence++;
+	exitCritical(primask);
+	return queued;
+}
+
+/* Text is dropped byte by byte, a long line may lose its tail. */
+extern "C" int traceText(const char *text, int length) {
+	Channel &c = channels[TRACE_TEXT];
+	uint32_t primask = enterCritical();
+	int n = space(c);
+
+	if(n > length) n = length;
+	for(int i = 0; i < n; i++) put(c, text[i]);
+	c.dropped += length - n;
+	exitCritical(primask);
+	return length - n;
+}
+
+static volatile bool flushing;
+
+/* Called from SysTick and from the main loop whenever it waits. A call
+ * that interrupts another one returns at once, the ring has one reader.
+ * Everything is written a word at a time, which takes a quarter of the
+ * FIFO slots and less SWO bandwidth than single bytes; only the last one
+ * to three bytes of text go out as bytes. When the debugger has not
+ * enabled a port its ring is discarded, always at an event boundary.
+ */
+void traceFlush() {
+	bool itm = (CoreDebug->DEMCR & CoreDebug_DEMCR_TRCENA_Msk) && (ITM->TCR & ITM_TCR_ITMENA_Msk);
+	uint32_t primask = enterCritical();
+
+	if(flushing) {
+		exitCritical(primask);
+		return;
+	}
+	flushing = true;
+	exitCritical(primask);
+
+	for(int port = 0; port < TRACE_CHANNELS; port++) {
+		Channel &c = channels[port];
+		uint16_t tail = c.tail;
+		uint16_t pending;
+
+		if(!itm || !(ITM->TER & (1UL << port))) {
+			c.tail = c.head;
+			continue;
+		}
+		while((pending = c.head - tail) != 0 && ITM->PORT[port].u32 != 0) {
+			if(pending < 4) {
+				ITM->PORT[port].u8 = c.buf[tail & c.mask];	// text only
+				tail++;
+			}
+			else {
+				ITM->PORT[port].u32 = c.buf[tail & c.mask] | (uint32_t)c.buf[(tail + 1) & c.mask] << 8 |
+						(uint32_t)c.buf[(tail + 2) & c.mask] << 16 | (uint32_t)c.buf[(tail + 3) & c.mask] << 24;
+				tail += 4;
+			}
+			c.tail = tail;
+		}
+	}
+	flushing = false;
+}
+
+uint32_t traceDropped(TraceChannel channel) {
+	return channels[channel].dropped;
+}
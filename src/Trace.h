@@ -0,0 +1,80 @@
+/*
+ * Trace.h
+ *
+ *  Created on: 19.10.2026
+ *
+ * Buffered, non-blocking trace over the ITM. Each channel is a stimulus
+ * port with its own RAM ring: writers copy into the ring and return, and
+ * traceFlush() moves as much as the ITM FIFO accepts. The FIFO holds a
+ * single word, so SysTick alone gets only a word or two out per ms;
+ * traceFlush() is also called while the main loop waits (Sleep() and the
+ * Modbus idle hook), which keeps up with the SWO line. When a ring is
+ * full the write is dropped and counted, so tracing never waits on the
+ * debug probe.
+ *
+ * Default load: sensor 100 Hz x 16 B, control 50 Hz x 24 B and Modbus
+ * about 20 transactions/s x 16 B, some 3 kB/s in all. Each ring holds a
+ * few hundred ms of its channel, enough to ride out a main loop pass that
+ * does not flush.
+ *
+ * Port 0 carries the printf text (retarget_itm.c). The other ports carry
+ * binary events, a whole number of 32-bit words each:
+ *     word 0  0xA5 | id << 8 | payload words << 16 | sequence << 24
+ *     word 1  timestamp, micros()
+ *     word 2.. payload
+ * The sequence counts every event of the channel, including dropped ones,
+ * so the host sees where events are missing. tools/itmdecode.py turns a
+ * SWO capture into one log per channel.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdint.h>
+
+enum TraceChannel {
+	TRACE_TEXT = 0,
+	TRACE_CONTROL = 1,
+	TRACE_MODBUS = 2,
+	TRACE_SENSOR = 3,
+	TRACE_CHANNELS
+};
+
+/* event ids, per channel */
+enum TraceEventId {
+	TRACE_CONTROL_STEP = 1,			// pressure, desired, speed | target << 8, dtUs
+	TRACE_MODBUS_TRANSACTION = 1,	// slave | function << 8 | status << 16, duration us
+	TRACE_SENSOR_SAMPLE = 1,		// pascal (Q16), status
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* printf backend: queue text on port 0, returns the number of bytes dropped */
+int traceText(const char *text, int length);
+
+#ifdef __cplusplus
+}
+
+static const uint8_t TRACE_MAX_PAYLOAD = 6;		// words
+
+/* Queue an event; false if the ring had no room for it. Safe from any
+ * context, including interrupts. */
+bool traceEvent(TraceChannel channel, uint8_t id, const uint32_t *payload, uint8_t words);
+
+inline bool traceEvent(TraceChannel channel, uint8_t id, uint32_t a, uint32_t b) {
+	uint32_t payload[2] = { a, b };
+	return traceEvent(channel, id, payload, 2);
+}
+
+inline bool traceEvent(TraceChannel channel, uint8_t id, uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+	uint32_t payload[4] = { a, b, c, d };
+	return traceEvent(channel, id, payload, 4);
+}
+
+void traceFlush();
+uint32_t traceDropped(TraceChannel channel);	// events (text: bytes) lost
+#endif
+
+#endif /* TRACE_H_ */
@@ -33,25 +33,27 @@
 //*****************************************************************************
 
 #include <stdlib.h>
+#include "Heap.h"
 
+// served from the fixed-block pools in Heap.cpp
 void *operator new(size_t size)
 {
-    return malloc(size);
+    return heapAllocate(size);
 }
 
 void *operator new[](size_t size)
 {
-    return malloc(size);
+    return heapAllocate(size);
 }
 
 void operator delete(void *p)
 {
-    free(p);
+    heapFree(p);
 }
 
 void operator delete[](void *p)
 {
-    free(p);
+    heapFree(p);
 }
 
 extern "C" int __aeabi_atexit(void *object,
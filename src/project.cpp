@@ -14,16 +14,42 @@
 #include <cstring>
 #include <cstdio>
 #include "ModbusMaster.h"
-#include "itm_class.h"
 #include "I2C.h"
+#include "PressureSensor.h"
+#include "SensorSampler.h"
 #include "DigitalIoPin.h"
-#include <string>
 #include "LiquidCrystal.h"
-#include <vector>
-#include <algorithm>
+#include "StreamingMedian.h"
+#include "FixedPid.h"
+#include "PidController.h"
+#include "RelayAutoTuner.h"
+#include "FeedforwardTable.h"
+#include "ControlScheduler.h"
+#include "Clock.h"
+#include "Profiler.h"
+#include "AbbDrive.h"
+#include "SetpointRamp.h"
+#include "TimerService.h"
+#include "Heap.h"
+#include "Trace.h"
+#include "Telemetry.h"
 #define	BUTTON_STEP 5
 #define FILTER_LEN	9
 #define TIMEOUT 5000			//ms
+#define SAMPLE_RATE 100			//Hz, a 12-bit read takes about 5 ms
+#define SAMPLE_TIMEOUT 100		//ms without a valid sample before showing an error
+#define CONTROL_RATE 50		//Hz, control step in the timer service interrupt
+#define TELEMETRY_RATE 25		//Hz, binary telemetry frames on the board UART, up to CONTROL_RATE; 0 for none
+#define RAMP_RATE 50			//%/s, fan speed slew rate
+#define RAMP_ACCEL 200			//%/s^2, rounds the ramp ends; 0 for a linear ramp
+#define DRIVE_WRITE_PERIOD 100	//ms, minimum time between reference writes
+#define DRIVE_START_TIMEOUT 5000	//ms, the main loop keeps bringing the drive up after this
+//#define PID_BENCHMARK			//compare float pid() and FixedPid cycle counts at startup
+static constexpr float PID_KP = 0.6f;		//0.425
+static constexpr float PID_KI = 0.007f;		//0.013
+static constexpr float PID_KD = 8.8f;		//50.0
+#define AUTOTUNE_STEP 15		//relay amplitude, % fan speed
+#define AUTOTUNE_HYSTERESIS 1	//Pa
 static volatile int counter;
 static volatile uint32_t systicks;
 
@@ -37,6 +63,8 @@ extern "C" {
 void SysTick_Handler(void)
 {
 	systicks++;
+	clockTick();
+	traceFlush();
 	if(counter > 0) counter--;
 }
 #ifdef __cplusplus
@@ -48,6 +76,7 @@ void Sleep(int ms)
 	counter = ms;
 	while(counter > 0) {
 		__WFI();
+		traceFlush();
 	}
 }
 
@@ -71,96 +100,39 @@ void printRegister(ModbusMaster& node, uint16_t reg) {
 	}
 }
 
-bool setFrequency(ModbusMaster& node, uint16_t freq) {
-	uint8_t result;
-	int ctr;
-	bool atSetpoint;
-	const int delay = 1;
-
-	node.writeSingleRegister(1, freq); // set motor frequency
-
-	//	printf("Set freq = %d\n", freq/40); // for debugging
-
-	// wait until we reach set point or timeout occurs
-	ctr = 0;
-	atSetpoint = false;
-	do {
-		Sleep(delay);
-		// read status word
-		result = node.readHoldingRegisters(3, 1);
-		// check if we are at setpoint
-		if (result == node.ku8MBSuccess) {
-			if(node.getResponseBuffer(0) & 0x0100) atSetpoint = true;
-		}
-		ctr++;
-	} while(ctr < 20 && !atSetpoint);
-
-	//	printf("Elapsed: %d\n", ctr * delay); // for debugging
-
-	return atSetpoint;
-}
-
-long i2cTest(I2C &i2c) {
-
-	uint8_t pressureData[3];
-	uint8_t readPressureCmd = 0xF1;
-	int16_t pressure = 0;
-	if (i2c.transaction(0x40, &readPressureCmd, 1, pressureData, 3)) {
-		pressure = (pressureData[0] << 8) | pressureData[1];
-		pressure = pressure/240*0.95;
-	}
-	else {
-		pressure = -1;	//in this case negative pressure means error
-	}
-	Sleep(5);
-	return pressure;
+/* pressure in whole Pa, clamped to the 0..255 range used by the control loop */
+uint8_t pressureToByte(int32_t pascal) {
+	int pa = PressureSensor::toIntPa(pascal);
+	if(pa < 0) return 0;
+	if(pa > 255) return 255;
+	return pa;
 }
 
-void setFanSpeed(ModbusMaster &node, uint8_t speed){
-	uint16_t freq = speed*200;
-	setFrequency(node, freq);
+/* returns the ticket that drive.isConfirmed() reports at setpoint */
+uint32_t setFanSpeed(AbbDrive &drive, uint8_t speed){
+	return drive.setSpeed(speed);
 }
 
 uint8_t filter(uint8_t noisy) {
-	static uint8_t arr[FILTER_LEN];
-	static uint8_t i = 0;
-	static bool initialised = false;
-//	uint8_t mean = 0;
-//	uint16_t sum = 0;
-	std::vector<uint8_t> filter_vec(arr, arr+FILTER_LEN-1);
-	std::vector<uint8_t>::iterator it;
-	if(initialised == false) {
-		arr[i] = noisy;
-		i++;
-		if(i == FILTER_LEN) {
-			initialised = true;
-			i = 0;
-		}
-	}
-	else {
-		arr[i] = noisy;
-		i++;
-		if(i == FILTER_LEN) {
-			i = 0;
-		}
-//		for(int j = 0; j < FILTER_LEN; j++) {
-//			sum += arr[j];
-//		}
-//		mean = sum/FILTER_LEN;
-		std::sort(filter_vec.begin(), filter_vec.end());
-		it = filter_vec.begin()+4;
-	}
+	PROFILE_ZONE(PROFILE_FILTER);
+	static StreamingMedian<uint8_t, FILTER_LEN> median;
+	return median.update(noisy);
+}
 
-	return *it;
+/* speed expected to hold the desired pressure: from the measured curve if
+ * one has been recorded, otherwise the old linear bias desired/127*100 % */
+Q16 feedforward(const FeedforwardTable &table, uint8_t desired_pressure) {
+	if(table.isValid()) return table.speedFor(Q16::fromInt(desired_pressure));
+	return Q16::fromInt(desired_pressure) * Q16::fromFloat(100.0f / 127.0f);
 }
 
 uint8_t pid(uint8_t desired_pressure, uint8_t actual_pressure, uint8_t delta_time) {
 	signed char error;
 	static signed char last_error;
 	float pTerm, dTerm, speed, bias_speed;
-	static float kp = 0.6;	 	//0.425
-	static float ki = 0.007;	 	//0.013
-	static float kd = 8.8;		//50.0
+	static float kp = PID_KP;
+	static float ki = PID_KI;
+	static float kd = PID_KD;
 	static float iTerm = 0;
 
 	bias_speed = ((float)desired_pressure)/127*100;
@@ -170,11 +142,6 @@ uint8_t pid(uint8_t desired_pressure, uint8_t actual_pressure, uint8_t delta_tim
 	dTerm = kd*(error - last_error)/delta_time;
 	speed = pTerm + iTerm + dTerm + bias_speed;
 
-//	itm.print(std::to_string(k));
-//	itm.print("  ");
-//	itm.print(std::to_string(delta_time));
-//	itm.print("\n");
-
 	if(speed > 100.0)
 		speed = 100.0;
 	else if(speed < 0.0)
@@ -183,6 +150,187 @@ uint8_t pid(uint8_t desired_pressure, uint8_t actual_pressure, uint8_t delta_tim
 	return speed;
 }
 
+/* State shared between the control step and the main loop. The main loop
+ * only writes the operator inputs and the request flags; the controller
+ * objects themselves are owned by the timer interrupt once it runs.
+ */
+struct ControlLoop {
+	SensorSampler *sampler;
+	PidController<> *pid;
+	RelayAutoTuner<> *tuner;
+	FeedforwardTable *ffTable;
+	SetpointRamp<> *ramp;
+	Telemetry *telemetry;
+	volatile bool automatic;
+	volatile uint8_t man_speed;
+	volatile uint8_t desired_pressure;
+	volatile bool sweepRequest;
+	volatile bool tuneRequest;
+	volatile uint8_t filtered_press;
+	volatile uint8_t speed;			// ramped fan speed for the main loop to send
+	volatile bool sweeping;
+	volatile bool tuning;
+	volatile uint32_t updates;		// incremented on every controller update
+	volatile uint8_t modbusStatus;	// latest drive transaction, for the telemetry
+	volatile uint16_t modbusTransactions;
+	volatile uint16_t modbusErrors;
+	uint32_t elapsedUs;				// since the last controller update
+	uint8_t target;					// controller output, input of the ramp
+	int32_t pascal;					// latest sensor average, Q16
+};
+
+/* Control step, runs from the ControlScheduler timer at CONTROL_RATE */
+void controlStep(void *context, uint32_t dtUs) {
+	PROFILE_ZONE(PROFILE_CONTROL_STEP);
+	ControlLoop *loop = static_cast<ControlLoop *>(context);
+	RelayAutoTuner<> &tuner = *loop->tuner;
+	FeedforwardTable &ffTable = *loop->ffTable;
+	int32_t pascal;
+	bool fresh = false;
+	uint8_t speed = loop->target;
+	uint32_t dtMs;
+	bool automatic = loop->automatic;
+
+	loop->elapsedUs += dtUs;
+	if(loop->sampler->collect(pascal)) {
+		loop->pascal = pascal;
+		loop->filtered_press = filter(pressureToByte(pascal));
+		fresh = true;
+	}
+
+	if(!automatic) {
+		tuner.reset();
+		if(loop->sweepRequest) {
+			loop->sweepRequest = false;
+			if(!ffTable.isSweeping()) ffTable.startSweep(millis());
+		}
+		if(ffTable.isSweeping()) speed = ffTable.sweepUpdate(Q16::fromInt(loop->filtered_press), millis());
+		else speed = loop->man_speed;
+		loop->pid->setManual(Q16::fromInt(speed));
+		loop->elapsedUs = 0;
+	}
+	else {
+		ffTable.abortSweep();
+		loop->pid->setAutomatic();	// continues bumplessly from the manual speed
+	}
+	if(automatic && fresh) {
+		if(loop->tuneRequest) {
+			loop->tuneRequest = false;
+			if(tuner.getState() != RelayAutoTuner<>::RUNNING) {
+				tuner.start(Q16::fromInt(loop->desired_pressure), loop->pid->output(),
+						Q16::fromInt(AUTOTUNE_STEP), Q16::fromInt(AUTOTUNE_HYSTERESIS), millis());
+			}
+		}
+		// the PID works in whole ms; the remainder carries over to the next update
+		dtMs = loop->elapsedUs / 1000;
+		loop->elapsedUs -= dtMs * 1000;
+		if(tuner.getState() == RelayAutoTuner<>::RUNNING) {
+			speed = tuner.update(Q16::fromInt(loop->filtered_press), millis()).toInt();
+		}
+		else {
+			PROFILE_ZONE(PROFILE_PID);
+			speed = loop->pid->update(Q16::fromInt(loop->desired_pressure), Q16::fromInt(loop->filtered_press),
+					dtMs, feedforward(ffTable, loop->desired_pressure)).toInt();
+		}
+		if(tuner.getState() == RelayAutoTuner<>::DONE || tuner.getState() == RelayAutoTuner<>::FAILED) {
+			if(tuner.getState() == RelayAutoTuner<>::DONE) {
+				loop->pid->setGains(tuner.getKp(), tuner.getKi(), tuner.getKd());
+			}
+			loop->pid->setManual(Q16::fromInt(speed));
+			loop->pid->setAutomatic();
+			tuner.reset();
+		}
+	}
+	loop->sweeping = ffTable.isSweeping();
+	loop->tuning = tuner.getState() == RelayAutoTuner<>::RUNNING;
+	loop->target = speed;
+	// the ramp runs on every step, also between controller updates
+	loop->speed = loop->ramp->update(Q16::fromInt(speed), (dtUs + 500) / 1000).round();
+	if(fresh || !automatic) loop->updates++;
+	traceEvent(TRACE_CONTROL, TRACE_CONTROL_STEP, loop->filtered_press, loop->desired_pressure,
+			loop->speed | (uint32_t)speed << 8, dtUs);
+	if(loop->telemetry->due()) {
+		TelemetrySample sample;
+		sample.setpoint = loop->desired_pressure;
+		sample.filtered = loop->filtered_press;
+		sample.pascal = loop->pascal;
+		sample.pTerm = loop->pid->proportional();
+		sample.iTerm = loop->pid->integral();
+		sample.dTerm = loop->pid->derivative();
+		sample.output = speed;
+		sample.speed = loop->speed;
+		sample.modbusStatus = loop->modbusStatus;
+		sample.modbusTransactions = loop->modbusTransactions;
+		sample.modbusErrors = loop->modbusErrors;
+		sample.flags = (automatic ? Telemetry::FLAG_AUTOMATIC : 0) | (loop->tuning ? Telemetry::FLAG_TUNING : 0) |
+				(loop->sweeping ? Telemetry::FLAG_SWEEPING : 0) | (fresh ? Telemetry::FLAG_FRESH : 0);
+		loop->telemetry->send(sample);
+	}
+}
+
+void printSchedulerStats(const ControlScheduler &scheduler) {
+	ControlScheduler::Stats stats;
+
+	scheduler.getStats(stats);
+	printf("ticks %lu overruns %lu max jitter %lu us max exec %lu us\n", (unsigned long)stats.ticks,
+			(unsigned long)stats.overruns, (unsigned long)stats.maxJitterUs, (unsigned long)stats.maxExecUs);
+	printf("us    <1");
+	for(int i = 1; i < ControlScheduler::BUCKETS; i++) printf(" <%d", 1 << i);
+	printf("\njitter");
+	for(int i = 0; i < ControlScheduler::BUCKETS; i++) printf(" %lu", (unsigned long)stats.jitter[i]);
+	printf("\nexec  ");
+	for(int i = 0; i < ControlScheduler::BUCKETS; i++) printf(" %lu", (unsigned long)stats.exec[i]);
+	printf("\n");
+}
+
+/* The main loop should not allocate once it runs; late allocations point to
+ * a std::string or to_string() creeping back in. */
+void printHeapStats() {
+	HeapStats stats;
+
+	heapGetStats(stats);
+	printf("heap allocations %lu frees %lu failures %lu late %lu, %lu bytes in use, peak %lu\n",
+			(unsigned long)stats.allocations, (unsigned long)stats.frees, (unsigned long)stats.failures,
+			(unsigned long)stats.lateAllocations, (unsigned long)stats.bytesInUse, (unsigned long)stats.bytesPeak);
+	for(int i = 0; i < HEAP_CLASSES; i++) {
+		printf("pool %4u B: %u/%u used, peak %u\n", stats.classSize[i], stats.classUsed[i],
+				stats.classBlocks[i], stats.classPeak[i]);
+	}
+}
+
+#ifdef PID_BENCHMARK
+/* Float reference pid() against FixedPid on the target: DWT cycle counts
+ * per call and the largest output difference over a synthetic run. Both
+ * controllers keep state, so this runs once before the control loop.
+ */
+void pidBenchmark() {
+	FixedPid<> fixedPid(Q16::fromFloat(PID_KP), Q16::fromFloat(PID_KI), Q16::fromFloat(PID_KD));
+	uint32_t floatCycles = 0, fixedCycles = 0, start;
+	int maxDiff = 0;
+	const int calls = 1000;
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	for(int i = 0; i < calls; i++) {
+		uint8_t desired = (i / 100) * 12;
+		uint8_t actual = (i * 37) % 128;
+		uint8_t dt = 10 + i % 20;
+		uint8_t a, b;
+
+		start = DWT->CYCCNT;
+		a = pid(desired, actual, dt);
+		floatCycles += DWT->CYCCNT - start;
+		start = DWT->CYCCNT;
+		b = fixedPid.update(desired, actual, dt);
+		fixedCycles += DWT->CYCCNT - start;
+		if(a - b > maxDiff) maxDiff = a - b;
+		if(b - a > maxDiff) maxDiff = b - a;
+	}
+	printf("pid float %lu, fixed %lu cycles/call, max difference %d\n",
+			(unsigned long)(floatCycles / calls), (unsigned long)(fixedCycles / calls), maxDiff);
+}
+#endif
+
 /**
  * @brief	Main UART program body
  * @return	Always returns 1
@@ -192,17 +340,42 @@ int main(void)
 	SystemCoreClockUpdate();
 	Chip_SWM_MovablePortPinAssign(SWM_SWO_O, 1, 2);// Set up SWO to PIO1_2  Needed for SWO printf
 	SysTick_Config(SystemCoreClock / 1000);/* Enable and setup SysTick Timer at a periodic rate */
-	Chip_RIT_Init(LPC_RITIMER);
+	clockInit();
+	profileInit();
+	TimerService::init();
 	Board_Init();
+#ifdef PID_BENCHMARK
+	pidBenchmark();
+#endif
 
 	ModbusMaster node(2); // Create modbus object that connects to slave id 2
 	node.begin(9600); // set transmission rate - other parameters are set inside the object and can't be changed here
-	node.writeSingleRegister(0, 0x0406); // prepare for starting
-	Sleep(1000); // give converter some time to set up
-	node.writeSingleRegister(0, 0x047F); // set drive to start mode
+	node.setFrameMode(true); // assemble and CRC-check responses in the UART ISR
+	node.idle(traceFlush); // drain the trace rings while waiting for the drive
+	AbbDrive drive(node);
+	uint32_t startTime = millis();
+	drive.start(); // steps through the ABB Drives profile states as the drive reports them
+	while(!drive.isRunning() && millis() - startTime < DRIVE_START_TIMEOUT) {
+		drive.poll();
+	}
+	printf("drive %s after %lu ms\n", drive.isRunning() ? "running" : "not ready",
+			(unsigned long)(millis() - startTime));
 
 	I2C i2c(0, 100000);
-	SWOITMclass itm;
+	PressureSensor sensor(i2c);
+	SensorSampler sampler(sensor, i2c, SAMPLE_RATE);
+	sampler.start();
+	PidController<> pidController(Q16::fromFloat(PID_KP), Q16::fromFloat(PID_KI), Q16::fromFloat(PID_KD));
+	RelayAutoTuner<> tuner;
+	FeedforwardTable ffTable;
+	ffTable.load();
+	SetpointRamp<> ramp(Q16::fromInt(RAMP_RATE), Q16::fromInt(RAMP_ACCEL));
+	Telemetry telemetry(CONTROL_RATE, TELEMETRY_RATE);
+	telemetry.begin();
+	ControlLoop loop = { &sampler, &pidController, &tuner, &ffTable, &ramp, &telemetry,
+			false, 0, 0, false, false, 0, 0, false, false, 0, 0, 0, 0, 0, 0, 0 };
+	ControlScheduler scheduler(controlStep, &loop, CONTROL_RATE);
+	scheduler.start();
 	DigitalIoPin button1(0, 16, true, true, true);
 	DigitalIoPin button2(0, 0, true, true, true);
 	DigitalIoPin button3(1, 3, true, true, true);
@@ -215,14 +388,22 @@ int main(void)
 	DigitalIoPin D7(0, 7, false, false, false);
 	LiquidCrystal lcd(&RS, &EN, &D4, &D5, &D6, &D7);
 
-	uint8_t man_speed = 0, speed = 0, desired_pressure = 0, actual_pressure = 0, delta_time = 0, filtered_press = 0;
-	uint32_t time1 = 0, time2 = 0;
+	/* Background work: buttons, Modbus and display. The control step itself
+	 * runs in the scheduler interrupt and only hands over the fan speed. */
+	uint8_t man_speed = 0, desired_pressure = 0, filtered_press = 0;
+	uint32_t updates = 0, lastWrite = 0;
 	uint16_t timeout = 0; 	//for timeout alert
-	std::string str;
+	int c;
 	bool mode = false;		//false: manual true: automatic
-//	float k = 0.7;
+	heapSeal();		// from here on nothing should allocate
 	while(1) {
 		while(!mode) {
+			c = Board_UARTGetChar();
+			if(c == 's') {
+				printSchedulerStats(scheduler);
+				printHeapStats();
+			}
+			if(c == 'p') profileDump();
 			if(button1.Read()) {
 				if(man_speed <= 100 - BUTTON_STEP)
 					man_speed += BUTTON_STEP;
@@ -231,33 +412,44 @@ int main(void)
 				if(man_speed >= BUTTON_STEP)
 					man_speed -= BUTTON_STEP;
 			}
+			loop.man_speed = man_speed;
 			if(button2.Read()) {
 				mode = true;
 				timeout = 0;
+				loop.automatic = true;	// also aborts a running sweep
 			}
-			setFanSpeed(node, man_speed);
+			if(button4.Read() || c == 'c') loop.sweepRequest = true;
+			setFanSpeed(drive, loop.speed);
+			drive.poll();
+			loop.modbusStatus = drive.getLastResult();
+			loop.modbusTransactions = drive.getTransactions();
+			loop.modbusErrors = drive.getErrors();
+			ffTable.poll();
 
 			/*	Print LCD	*/
-			lcd.clear();
-			lcd.setCursor(0, 0);
-			lcd.print("Fan Speed: ");
-			lcd.print(std::to_string(man_speed));
-			lcd.setCursor(0,  1);
-			lcd.print("Pressure:  ");
-			actual_pressure = i2cTest(i2c);
-			filtered_press = filter(actual_pressure);
-			if(actual_pressure >= 0)
-				lcd.print(std::to_string(filtered_press));
-			else lcd.print("Error");
+			lcd.frameClear();
+			lcd.frameSetCursor(0, 0);
+			lcd.framePrint(loop.sweeping ? "Sweep:     " : "Fan Speed: ");
+			lcd.framePrint(loop.speed);
+			lcd.frameSetCursor(0,  1);
+			lcd.framePrint("Pressure:  ");
+			if(!sampler.isStale(SAMPLE_TIMEOUT))
+				lcd.framePrint(loop.filtered_press);
+			else lcd.framePrint("Error");
+			lcd.flush();	// only the changed cells
 			Sleep(300);
 		}
 		while(mode) {
-			time1 = millis();
-//			if(button4.Read()) {
-//				k += 0.02;
-//			}
+			c = Board_UARTGetChar();
+			if(c == 's') {
+				printSchedulerStats(scheduler);
+				printHeapStats();
+			}
+			if(c == 'p') profileDump();
+			if(button4.Read() || c == 't') loop.tuneRequest = true;
 			if(button2.Read()) {
 				mode = false;
+				loop.automatic = false;	// also stops a running auto-tune
 				Sleep(200);
 			}
 			if(button1.Read()) {
@@ -270,42 +462,44 @@ int main(void)
 				if(desired_pressure >= BUTTON_STEP)
 					desired_pressure -= BUTTON_STEP;
 			}
-			actual_pressure = i2cTest(i2c);
-			if(actual_pressure >= 0) {
-				time2 = millis();
-				if(time2 < time1) 			//the systick has been reset
-					delta_time = 4294967295 - time1 + time2;
-				else delta_time = time2 - time1;
-//				itm.print(delta_time);
-				filtered_press = filter(actual_pressure);
-				speed = pid(desired_pressure, filtered_press, delta_time);
-				setFanSpeed(node, speed);
-
-				lcd.clear();
-				lcd.setCursor(0, 0);
-				lcd.print("Desire: ");
-				lcd.print(std::to_string(desired_pressure));
-				lcd.setCursor(0, 1);
-				lcd.print("Actual: ");
-				str = std::to_string(filtered_press);
-				lcd.print(str);
+			loop.desired_pressure = desired_pressure;
+			if(millis() - lastWrite >= DRIVE_WRITE_PERIOD) {
+				// the ramp moves at the control rate; the drive only sees a sample of it
+				setFanSpeed(drive, loop.speed);
+				lastWrite = millis();
+			}
+			if(loop.updates != updates) {
+				updates = loop.updates;
+				filtered_press = loop.filtered_press;
+
+				lcd.frameClear();
+				lcd.frameSetCursor(0, 0);
+				lcd.framePrint(loop.tuning ? "Tuning: " : "Desire: ");
+				lcd.framePrint(desired_pressure);
+				lcd.frameSetCursor(0, 1);
+				lcd.framePrint("Actual: ");
+				lcd.framePrint(filtered_press);
+			}
+			else if(sampler.isStale(SAMPLE_TIMEOUT)) {
+				lcd.frameSetCursor(8, 1);
+				lcd.framePrint("Error   ");
 			}
-			else lcd.print("Error");
-			Board_UARTPutSTR(str.c_str());
-			Board_UARTPutChar(',');
-			str = std::to_string(desired_pressure);
-			Board_UARTPutSTR(str.c_str());
-			Board_UARTPutChar('\n');
-			if(filtered_press >= desired_pressure-1 && filtered_press <= desired_pressure+1) {
+			drive.poll();
+			loop.modbusStatus = drive.getLastResult();
+			loop.modbusTransactions = drive.getTransactions();
+			loop.modbusErrors = drive.getErrors();
+			ffTable.poll();
+			if((filtered_press >= desired_pressure-1 && filtered_press <= desired_pressure+1) || loop.tuning) {
 				timeout = 0;
 			}
 			else {
 				timeout++;
 				if(timeout >= 100) {
-					lcd.setCursor(0, 0);
-					lcd.print("Unreachable");
+					lcd.frameSetCursor(0, 0);
+					lcd.framePrint("Unreachable");
 				}
 			}
+			lcd.flush();
 			Sleep(10);
 		}
 	}
@@ -28,6 +28,7 @@
 //*****************************************************************************
 
 #include <stdint.h>
+#include "Trace.h"
 
 // ******************************************************************
 // Cortex-M SWO Trace / Debug registers used for accessing ITM
@@ -78,27 +79,14 @@ int __sys_write(int iFileHandle, char *pcBuffer, int iLength) {
 int _write(int iFileHandle, char *pcBuffer, int iLength) {
 #endif
 
-	int32_t num = 0;
-
 	// TODO : Should potentially check that iFileHandle == 1 to confirm
 	// that write is to stdout
 
-	// check if debugger connected and ITM channel enabled for tracing
-	if ((DEMCR & TRCENA) &&
-	// ITM enabled
-			(ITM_TCR & ITM_TCR_ITMENA) &&
-			// ITM Port #0 enabled
-			(ITM_TER & ITM_TER_PORT0ENA)) {
-
-		while (num < iLength) {
-			while (ITM_Port32(0) == 0) {
-			}
-			ITM_Port8(0) = pcBuffer[num++];
-		}
-		return 0;
-	} else
-		// Function returns number of unwritten bytes if error
-		return (iLength);
+	// Queue the characters for ITM port 0 instead of waiting on the FIFO
+	// for each one; Trace.cpp drains the queue from SysTick and drops what
+	// does not fit, so printf never stalls the caller.
+	traceText(pcBuffer, iLength);
+	return 0;
 }
 
 #if defined (__REDLIB__)
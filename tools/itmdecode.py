@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+"""Split a raw SWO capture into one log per trace channel.
+
+Capture the SWO pin to a file without the TPIU formatter (for example
+OpenOCD "tpiu config internal swo.bin uart off <cpu hz>") and run
+
+    itmdecode.py swo.bin -o trace/
+
+Port 0 (printf) goes to text.log. The binary event channels of Trace.h go
+to control.csv, modbus.csv and sensor.csv with one row per event. Gaps in
+an event sequence are events the firmware dropped because its ring was
+full; they are counted in the summary together with ITM overflows.
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+EVENT_SYNC = 0xA5
+
+# port -> (name, {event id: (field names, decoder)})
+CHANNELS = {
+    1: ("control", {
+        1: (("pressure", "desired", "speed", "target", "dt_us"),
+            lambda p: (p[0], p[1], p[2] & 0xFF, (p[2] >> 8) & 0xFF, p[3])),
+    }),
+    2: ("modbus", {
+        1: (("slave", "function", "status", "response_us"),
+            lambda p: (p[0] & 0xFF, (p[0] >> 8) & 0xFF, (p[0] >> 16) & 0xFF, p[1])),
+    }),
+    3: ("sensor", {
+        1: (("pascal", "status"),
+            lambda p: ("%.3f" % (struct.unpack("<i", struct.pack("<I", p[0]))[0] / 65536.0), p[1])),
+    }),
+}
+
+
+def demux(data):
+    """Return ({port: bytearray}, overflows) from an ITM packet stream."""
+    ports = {}
+    overflows = 0
+    i = 0
+    n = len(data)
+    while i < n:
+        header = data[i]
+        i += 1
+        if header & 0x03:
+            size = (1, 2, 4)[(header & 0x03) - 1]
+            if not header & 0x04:
+                # instrumentation packet, software source
+                ports.setdefault(header >> 3, bytearray()).extend(data[i:i + size])
+            i += size
+        elif header == 0x00:
+            # synchronization packet: zeros ending in 0x80
+            while i < n and data[i] == 0x00:
+                i += 1
+            if i < n and data[i] == 0x80:
+                i += 1
+        elif header == 0x70:
+            overflows += 1
+        elif (header & 0x0F) == 0x00 or (header & 0x0B) == 0x08 or header in (0x94, 0xB4):
+            # local timestamp, extension or global timestamp: skip continuation bytes
+            if header & 0x80:
+                while i < n and data[i] & 0x80:
+                    i += 1
+                i += 1
+    return ports, overflows
+
+
+def events(stream):
+    """Yield (sequence, id, timestamp, payload) from a channel's byte stream.
+
+    A word that does not start with the sync byte is skipped one byte at a
+    time, so the decoder finds its way back after lost data.
+    """
+    i = 0
+    skipped = 0
+    while i + 8 <= len(stream):
+        if stream[i] != EVENT_SYNC:
+            i += 1
+            skipped += 1
+            continue
+        _, event_id, words, seq = stream[i:i + 4]
+        end = i + 8 + 4 * words
+        if end > len(stream):
+            break
+        timestamp = struct.unpack_from("<I", stream, i + 4)[0]
+        payload = struct.unpack_from("<%dI" % words, stream, i + 8)
+        yield seq, event_id, timestamp, payload
+        i = end
+    if skipped:
+        sys.stderr.write("skipped %d bytes while resynchronizing\n" % skipped)
+
+
+def write_channel(name, decoders, stream, out_dir):
+    path = os.path.join(out_dir, name + ".csv")
+    count = 0
+    lost = 0
+    last_seq = None
+    with open(path, "w") as out:
+        header_written = set()
+        for seq, event_id, timestamp, payload in events(stream):
+            if last_seq is not None:
+                lost += (seq - last_seq - 1) & 0xFF
+            last_seq = seq
+            fields, decode = decoders.get(event_id, (None, None))
+            if fields is None:
+                fields = tuple("p%d" % k for k in range(len(payload)))
+                values = payload
+            else:
+                values = decode(payload)
+            if event_id not in header_written:
+                out.write("# id %d: time_us,seq,%s\n" % (event_id, ",".join(fields)))
+                header_written.add(event_id)
+            out.write("%d,%d,%s\n" % (timestamp, seq, ",".join(str(v) for v in values)))
+            count += 1
+    return path, count, lost
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", nargs="?", help="raw SWO capture (default: stdin)")
+    parser.add_argument("-o", "--out", default=".", help="output directory")
+    args = parser.parse_args()
+
+    if args.capture:
+        with open(args.capture, "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+
+    os.makedirs(args.out, exist_ok=True)
+    ports, overflows = demux(data)
+
+    text = ports.pop(0, bytearray())
+    with open(os.path.join(args.out, "text.log"), "wb") as out:
+        out.write(text)
+    print("text.log: %d bytes" % len(text))
+
+    for port, (name, decoders) in sorted(CHANNELS.items()):
+        path, count, lost = write_channel(name, decoders, ports.pop(port, bytearray()), args.out)
+        print("%s: %d events, %d missing" % (path, count, lost))
+    for port in sorted(ports):
+        print("port %d: %d bytes ignored" % (port, len(ports[port])))
+    if overflows:
+        print("%d ITM overflow packets, the SWO clock may be too slow" % overflows)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,124 @@
+/*
+ * mediantest.cpp
+ *
+ *  Created on: 19.10.2026
+ *
+ * Host check and benchmark for src/StreamingMedian.h. Every update is
+ * compared against the median of a std::sort-ed copy of the window, for
+ * window sizes 1 and 2, even and odd sizes and the firmware's FILTER_LEN.
+ * The old vector-and-sort filter() is then timed against the new one.
+ *
+ *     g++ -std=c++11 -O2 -Wall -I../src mediantest.cpp -o mediantest && ./mediantest
+ */
+
+#include "StreamingMedian.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <stdint.h>
+#include <vector>
+
+#define FILTER_LEN	9
+
+static uint32_t seed = 12345;
+
+/* small noise around a slowly moving level, with occasional spikes, like
+ * the pressure readings; plain random values are mixed in to hit every
+ * insertion path */
+static uint8_t nextSample(int i) {
+	seed = seed * 1664525 + 1013904223;
+	uint32_t r = seed >> 8;
+	if(i % 1000 < 500) return r & 0xFF;
+	int level = 60 + (i / 200) % 40;
+	if(r % 50 == 0) return (r >> 8) & 0xFF;
+	return level + (int)(r % 7) - 3;
+}
+
+template <unsigned N>
+static bool check(int samples) {
+	StreamingMedian<uint8_t, N> median;
+	std::deque<uint8_t> window;
+
+	for(int i = 0; i < samples; i++) {
+		uint8_t value = nextSample(i);
+		uint8_t got = median.update(value);
+
+		window.push_back(value);
+		if(window.size() > N) window.pop_front();
+		std::vector<uint8_t> sorted(window.begin(), window.end());
+		std::sort(sorted.begin(), sorted.end());
+		uint8_t expected = sorted[sorted.size() / 2];	// upper median, as median()
+
+		if(got != expected || median.size() != sorted.size()) {
+			printf("N=%u: sample %d: median %u, expected %u\n", N, i, got, expected);
+			return false;
+		}
+	}
+	median.reset();
+	if(median.size() != 0 || median.update(42) != 42) {
+		printf("N=%u: reset failed\n", N);
+		return false;
+	}
+	printf("N=%-3u ok\n", N);
+	return true;
+}
+
+/* filter() before user-031, with the iterator initialized: the original
+ * dereferenced it uninitialized while the window was filling */
+static uint8_t oldFilter(uint8_t noisy) {
+	static uint8_t arr[FILTER_LEN];
+	static uint8_t i = 0;
+	static bool initialised = false;
+	std::vector<uint8_t> filter_vec(arr, arr+FILTER_LEN-1);
+	std::vector<uint8_t>::iterator it = filter_vec.begin();
+	if(initialised == false) {
+		arr[i] = noisy;
+		i++;
+		if(i == FILTER_LEN) {
+			initialised = true;
+			i = 0;
+		}
+	}
+	else {
+		arr[i] = noisy;
+		i++;
+		if(i == FILTER_LEN) {
+			i = 0;
+		}
+		std::sort(filter_vec.begin(), filter_vec.end());
+		it = filter_vec.begin()+4;
+	}
+
+	return *it;
+}
+
+static uint8_t newFilter(uint8_t noisy) {
+	static StreamingMedian<uint8_t, FILTER_LEN> median;
+	return median.update(noisy);
+}
+
+template <typename Filter>
+static double nsPerSample(Filter filter, const std::vector<uint8_t> &input) {
+	unsigned sum = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for(size_t i = 0; i < input.size(); i++) sum += filter(input[i]);
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	if(sum == 1) printf(" ");	// keep the loop
+	return std::chrono::duration<double, std::nano>(end - start).count() / input.size();
+}
+
+int main() {
+	const int samples = 100000;
+	bool ok = check<1>(samples) && check<2>(samples) && check<3>(samples) &&
+			check<8>(samples) && check<FILTER_LEN>(samples) && check<31>(samples) &&
+			check<64>(samples);
+	if(!ok) return EXIT_FAILURE;
+
+	std::vector<uint8_t> input(2000000);
+	for(size_t i = 0; i < input.size(); i++) input[i] = nextSample(i);
+	printf("old filter(): %6.1f ns/sample\n", nsPerSample(oldFilter, input));
+	printf("new filter(): %6.1f ns/sample\n", nsPerSample(newFilter, input));
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+"""Flat profile from the firmware's profileDump() output.
+
+Capture the SWO/ITM console to a file (or pipe it in) and run
+
+    profreport.py itm.log
+
+The last complete "PROF begin ... PROF end" block is reported, sorted by
+total time. Zone times are inclusive, so nested zones (pid inside
+control_step) are counted in both. The share column is each zone's part
+of the summed zone totals, not of elapsed time, and with nested zones
+that sum holds the nested time twice.
+"""
+
+import argparse
+import sys
+
+
+def parse_blocks(lines):
+    """Yield (clock_hz, zones) for every complete block in the input."""
+    block = None
+    clock = 0
+    for line in lines:
+        fields = line.split()
+        if len(fields) < 2 or fields[0] != "PROF":
+            continue
+        if fields[1] == "begin":
+            block = []
+            clock = int(fields[2]) if len(fields) > 2 else 0
+        elif fields[1] == "end":
+            if block is not None:
+                yield clock, block
+            block = None
+        elif block is not None and len(fields) == 8:
+            name = fields[1]
+            count, lo, avg, hi, total_hi, total_lo = (int(f) for f in fields[2:])
+            block.append({
+                "name": name,
+                "count": count,
+                "min": lo,
+                "avg": avg,
+                "max": hi,
+                "total": (total_hi << 32) | total_lo,
+            })
+
+
+def report(clock, zones, out):
+    mhz = clock / 1e6 if clock else None
+    grand = sum(z["total"] for z in zones) or 1
+
+    def us(cycles):
+        return "%10.1f" % (cycles / mhz) if mhz else "%10s" % "-"
+
+    out.write("core clock: %s\n" % ("%.1f MHz" % mhz if mhz else "unknown"))
+    out.write("%-20s %10s %7s %10s %10s %10s %10s %10s %10s\n" % (
+        "zone", "calls", "share", "total ms", "min cyc", "avg cyc", "max cyc", "avg us", "max us"))
+    for z in sorted(zones, key=lambda z: z["total"], reverse=True):
+        if z["count"] == 0:
+            continue
+        total_ms = "%10.2f" % (z["total"] / mhz / 1000) if mhz else "%10s" % "-"
+        out.write("%-20s %10d %6.1f%% %s %10d %10d %10d %s %s\n" % (
+            z["name"], z["count"], 100.0 * z["total"] / grand, total_ms,
+            z["min"], z["avg"], z["max"], us(z["avg"]), us(z["max"])))
+    idle = [z["name"] for z in zones if z["count"] == 0]
+    if idle:
+        out.write("not entered: %s\n" % ", ".join(idle))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("log", nargs="?", help="ITM capture (default: stdin)")
+    parser.add_argument("--clock", type=float, help="core clock in MHz, overrides the dump")
+    args = parser.parse_args()
+
+    source = open(args.log, errors="replace") if args.log else sys.stdin
+    blocks = list(parse_blocks(source))
+    if not blocks:
+        sys.exit("no complete PROF block found")
+    clock, zones = blocks[-1]
+    if args.clock:
+        clock = args.clock * 1e6
+    report(clock, zones, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,79 @@
+/*
+ * ramptest.cpp
+ *
+ *  Created on: 19.10.2026
+ *
+ * Host check for src/SetpointRamp.h at the 50 Hz control rate. With an
+ * acceleration limit a step is a trapezoidal (or, if the rate limit is
+ * never reached, triangular) velocity profile, so the time to arrive and
+ * the peak velocity are known; the output must get there in that time
+ * without overshoot. The long steps are the ones whose braking term
+ * 2 a |error| does not fit a Q16.
+ *
+ *     g++ -std=c++11 -O2 -Wall -I../src ramptest.cpp -o ramptest && ./ramptest
+ */
+
+#include "SetpointRamp.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+static const uint32_t CONTROL_MS = 20;
+
+struct Case {
+	double rate, accel;		// per s, per s^2 (0: linear ramp)
+	double from, to;
+};
+
+static bool run(const Case &c) {
+	SetpointRamp<> ramp(Q16::fromFloat(c.rate), Q16::fromFloat(c.accel));
+	double distance = fabs(c.to - c.from);
+	double peak = c.rate, expected;
+	double vMax = 0, out = c.from;
+	uint32_t ms = 0;
+	bool overshoot = false;
+
+	if(c.accel > 0) {
+		if(c.rate * c.rate > c.accel * distance) peak = sqrt(c.accel * distance);	// triangular
+		expected = distance / peak + peak / c.accel;
+	}
+	else expected = distance / c.rate;
+
+	ramp.reset(Q16::fromFloat(c.from));
+	while(!ramp.isSettled(Q16::fromFloat(c.to)) && ms < 600000) {
+		out = ramp.update(Q16::fromFloat(c.to), CONTROL_MS).toFloat();
+		ms += CONTROL_MS;
+		if(fabs(ramp.getVelocity().toFloat()) > vMax) vMax = fabs(ramp.getVelocity().toFloat());
+		if((c.to - out) * (c.to - c.from) < 0) overshoot = true;
+	}
+
+	/* The velocity is updated before each step and the output snaps to the
+	 * target from within one step, so the discrete ramp arrives a little
+	 * early; a saturated braking term makes it seconds late instead. */
+	double slack = CONTROL_MS / 1000.0;
+	bool timeOk = fabs(ms / 1000.0 - expected) <= 2 * slack + 0.06 * expected;
+	bool peakOk = fabs(vMax - peak) <= 0.03 * peak + (c.accel > 0 ? c.accel * slack : 0);
+	bool ok = timeOk && peakOk && !overshoot;
+
+	printf("rate %6.0f accel %6.0f  %6.0f -> %6.0f: %5.2f s (expected %5.2f), peak %6.1f/s (expected %6.1f)%s%s\n",
+			c.rate, c.accel, c.from, c.to, ms / 1000.0, expected, vMax, peak,
+			overshoot ? ", overshoot" : "", ok ? "" : "  <-- FAIL");
+	return ok;
+}
+
+int main() {
+	static const Case cases[] = {
+		{ 50, 200, 0, 100 },		// RAMP_RATE, RAMP_ACCEL, a full-scale step
+		{ 50, 200, 100, 0 },
+		{ 50, 200, 40, 43 },		// short, triangular
+		{ 50, 0, 0, 100 },			// linear
+		{ 1000, 200, 0, 500 },		// 2 a |error| up to 200000, beyond Q16
+		{ 1000, 200, 500, -500 },
+		{ 1500, 100, -10000, 10000 },
+	};
+	bool ok = true;
+
+	for(unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) ok &= run(cases[i]);
+	printf(ok ? "all ok\n" : "FAILED\n");
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+"""Decode the binary telemetry frames of Telemetry.cpp into CSV.
+
+Read a capture of the board UART (or the port itself, with pyserial) and
+write one CSV row per frame:
+
+    telemetry.py capture.bin > run.csv
+    telemetry.py --port /dev/ttyACM0 > run.csv
+
+Frames are COBS encoded and end in a zero byte. Frames with a bad CRC or
+length are skipped; gaps in the sequence number are frames the firmware
+dropped because its transmit ring was full. Both are counted on stderr.
+"""
+
+import argparse
+import struct
+import sys
+
+FRAME_SAMPLE = 1
+SAMPLE = struct.Struct("<BHIBBiiiiBBBHHB")
+FIELDS = ("seq", "time_us", "setpoint", "filtered", "pascal", "p", "i", "d",
+          "output", "speed", "modbus", "transactions", "errors",
+          "automatic", "tuning", "sweeping", "fresh")
+FLAG_AUTOMATIC = 0x01
+FLAG_TUNING = 0x02
+FLAG_SWEEPING = 0x04
+FLAG_FRESH = 0x08
+
+
+def _crc_table():
+    table = []
+    for byte in range(256):
+        crc = byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+        table.append(crc)
+    return table
+
+
+CRC_TABLE = _crc_table()
+
+
+def crc16(data):
+    """CRC-16/Modbus, as crc16_update() in the firmware."""
+    crc = 0xFFFF
+    for byte in data:
+        crc = (crc >> 8) ^ CRC_TABLE[(crc ^ byte) & 0xFF]
+    return crc
+
+
+def cobs_decode(frame):
+    """Decode one frame without its delimiter; None if it is malformed."""
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame):
+            return None
+        out += frame[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+def q16(raw):
+    return raw / 65536.0
+
+
+class Decoder:
+    """Turns a byte stream into raw sample tuples and keeps the error counts.
+
+    A tuple holds the frame fields after the type byte, in frame order:
+    seq, time_us, setpoint, filtered, pascal, p, i, d (the last four raw
+    Q16), output, speed, modbus, transactions, errors, flags. The Modbus
+    transaction and error counts are cumulative and wrap at 16 bits.
+    """
+
+    def __init__(self):
+        self.pending = bytearray()
+        self.bad = 0
+        self.missing = 0
+        self.frames = 0
+        self.last_seq = None
+
+    def feed(self, data):
+        self.pending += data
+        while True:
+            end = self.pending.find(b"\0")
+            if end < 0:
+                return
+            raw = bytes(self.pending[:end])
+            del self.pending[:end + 1]
+            if not raw:
+                continue
+            sample = self.parse(raw)
+            if sample is not None:
+                yield sample
+
+    def parse(self, raw):
+        payload = cobs_decode(raw)
+        if payload is None or len(payload) != SAMPLE.size + 2 or payload[0] != FRAME_SAMPLE:
+            self.bad += 1
+            return None
+        if crc16(payload[:-2]) != struct.unpack_from("<H", payload, SAMPLE.size)[0]:
+            self.bad += 1
+            return None
+        sample = SAMPLE.unpack_from(payload)[1:]
+        seq = sample[0]
+        if self.last_seq is not None:
+            self.missing += (seq - self.last_seq - 1) & 0xFFFF
+        self.last_seq = seq
+        self.frames += 1
+        return sample
+
+
+def to_dict(sample):
+    """Raw sample tuple to named values in engineering units."""
+    (seq, time_us, setpoint, filtered, pascal, p, i, d,
+     output, speed, modbus, transactions, errors, flags) = sample
+    return {
+        "seq": seq, "time_us": time_us, "setpoint": setpoint, "filtered": filtered,
+        "pascal": q16(pascal), "p": q16(p), "i": q16(i), "d": q16(d),
+        "output": output, "speed": speed, "modbus": modbus,
+        "transactions": transactions, "errors": errors,
+        "automatic": int(bool(flags & FLAG_AUTOMATIC)), "tuning": int(bool(flags & FLAG_TUNING)),
+        "sweeping": int(bool(flags & FLAG_SWEEPING)), "fresh": int(bool(flags & FLAG_FRESH)),
+    }
+
+
+def chunks(args):
+    """Yield raw byte chunks from the capture file, stdin or a serial port."""
+    if args.port:
+        import serial  # pyserial, only needed for live capture
+        with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+            while True:
+                data = port.read(4096)
+                if data:
+                    yield data
+    else:
+        stream = open(args.capture, "rb") if args.capture else sys.stdin.buffer
+        with stream:
+            while True:
+                data = stream.read(65536)
+                if not data:
+                    return
+                yield data
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", nargs="?", help="raw capture (default: stdin)")
+    parser.add_argument("--port", help="read a serial port instead")
+    parser.add_argument("--baud", type=int, default=115200)
+    args = parser.parse_args()
+
+    decoder = Decoder()
+    out = sys.stdout
+    out.write(",".join(FIELDS) + "\n")
+    try:
+        for data in chunks(args):
+            for sample in map(to_dict, decoder.feed(data)):
+                out.write(",".join(
+                    ("%.3f" % sample[f]) if isinstance(sample[f], float) else str(sample[f])
+                    for f in FIELDS) + "\n")
+    except KeyboardInterrupt:
+        pass
+    sys.stderr.write("%d frames, %d missing, %d bad\n" % (decoder.frames, decoder.missing, decoder.bad))
+
+
+if __name__ == "__main__":
+    main()
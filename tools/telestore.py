@@ -0,0 +1,500 @@
+#!/usr/bin/env python3
+"""Record the firmware telemetry into a chunked columnar store and analyse it.
+
+    telestore.py record /dev/ttyACM0 run.tls      # serial device, pty or capture file
+    telestore.py info run.tls
+    telestore.py query run.tls --from 2026-10-19T08:00 --to +600 > part.csv
+    telestore.py kpi run.tls --from +3600
+
+Samples are buffered per column and written in chunks of CHUNK_ROWS rows
+(or every --flush seconds while recording live). Each column of a chunk
+is zlib compressed on its own, so a query reads only the columns it
+needs. A sidecar index (run.tls.idx) holds the time range and offset of
+every chunk; range queries bisect it and read only the chunks that
+overlap, one at a time, so memory use does not grow with the file.
+"reindex" rebuilds a lost or truncated index from the chunk headers.
+
+Times are stored as microseconds since the Unix epoch. The firmware
+timestamp (micros(), wraps after 71 minutes) is unwrapped and anchored to
+the host clock at the first frame (for a capture file, at --start or
+the file's modification time); a board reset or a long pause re-anchors
+it. --from and --to take an ISO date/time or +seconds from
+the first sample.
+
+kpi splits the automatic-mode data into setpoint steps and reports for
+each: 10-90 % rise time, overshoot, settling time into the band, IAE of
+the pressure error and the Modbus error rate: failed drive transactions
+over all drive transactions, from the cumulative counters in the frames.
+"""
+
+import argparse
+import array
+import bisect
+import datetime
+import os
+import select
+import stat
+import struct
+import sys
+import time
+import zlib
+
+from telemetry import Decoder, q16, FLAG_AUTOMATIC
+
+MAGIC = b"TLS2"
+CHUNK_MAGIC = b"CHNK"
+CHUNK_ROWS = 4096
+CHUNK = struct.Struct("<4sIqqI")       # magic, rows, first time, last time, column count
+INDEX = struct.Struct("<qqQI4x")       # first time, last time, offset, rows
+
+# name, array type code; the stored order. Q16 values are kept raw.
+COLUMNS = (
+    ("time", "q"), ("seq", "H"), ("setpoint", "B"), ("filtered", "B"),
+    ("pascal", "i"), ("p", "i"), ("i", "i"), ("d", "i"),
+    ("output", "B"), ("speed", "B"), ("modbus", "B"),
+    ("transactions", "H"), ("errors", "H"), ("flags", "B"),
+)
+COLUMN_INDEX = {name: k for k, (name, _) in enumerate(COLUMNS)}
+Q16_COLUMNS = ("pascal", "p", "i", "d")
+
+WRAP = 1 << 32
+RESYNC_US = 2000000     # device and host clock disagree by more: re-anchor
+
+
+def to_le(values):
+    if sys.byteorder == "big":
+        values = array.array(values.typecode, values)
+        values.byteswap()
+    return values.tobytes()
+
+
+def from_le(typecode, data):
+    values = array.array(typecode)
+    values.frombytes(data)
+    if sys.byteorder == "big":
+        values.byteswap()
+    return values
+
+
+class DeviceClock:
+    """Maps the wrapping firmware micros() onto epoch microseconds."""
+
+    def __init__(self, live, start_us):
+        self.live = live
+        self.start_us = start_us
+        self.offset = None
+        self.last = None
+        self.last_time = None
+
+    def convert(self, device_us, host_us):
+        if self.last is not None and device_us < self.last and self.last - device_us > WRAP // 2:
+            self.offset += WRAP
+        self.last = device_us
+        if self.offset is None:
+            self.offset = (host_us if self.live else self.start_us) - device_us
+        t = self.offset + device_us
+        if self.live and abs(t - host_us) > RESYNC_US:
+            self.offset = host_us - device_us
+            t = host_us
+        if self.last_time is not None and t <= self.last_time:
+            # board reset, or a re-anchor that would move time back: keep
+            # the stored times increasing, the queries rely on it
+            self.offset += self.last_time + 1 - t
+            t = self.last_time + 1
+        self.last_time = t
+        return t
+
+
+class Writer:
+    def __init__(self, path):
+        self.path = path
+        new = not os.path.exists(path) or os.path.getsize(path) == 0
+        self.data = open(path, "ab")
+        if new:
+            self.data.write(MAGIC)
+        self.index = open(path + ".idx", "ab")
+        self.columns = [array.array(code) for _, code in COLUMNS]
+        self.rows = 0
+        self.chunks = 0
+
+    def append(self, t, sample):
+        self.columns[0].append(t)
+        for column, value in zip(self.columns[1:], sample[:1] + sample[2:]):
+            column.append(value)
+        self.rows += 1
+        if self.rows >= CHUNK_ROWS:
+            self.flush()
+
+    def flush(self):
+        if self.rows == 0:
+            return
+        blobs = [zlib.compress(to_le(column), 1) for column in self.columns]
+        times = self.columns[0]
+        offset = self.data.tell()
+        self.data.write(CHUNK.pack(CHUNK_MAGIC, self.rows, times[0], times[-1], len(blobs)))
+        self.data.write(struct.pack("<%dI" % len(blobs), *(len(b) for b in blobs)))
+        for blob in blobs:
+            self.data.write(blob)
+        self.data.flush()
+        # the index entry follows the data, so a crash leaves at most an unindexed chunk
+        self.index.write(INDEX.pack(times[0], times[-1], offset, self.rows))
+        self.index.flush()
+        self.columns = [array.array(code) for _, code in COLUMNS]
+        self.rows = 0
+        self.chunks += 1
+
+    def close(self):
+        self.flush()
+        self.data.close()
+        self.index.close()
+
+
+def scan_chunks(path):
+    """Yield index entries from the chunk headers, skipping the column data."""
+    with open(path, "rb") as f:
+        if f.read(len(MAGIC)) != MAGIC:
+            raise SystemExit("%s: not a telemetry store" % path)
+        while True:
+            offset = f.tell()
+            header = f.read(CHUNK.size)
+            if len(header) < CHUNK.size:
+                return
+            magic, rows, first, last, count = CHUNK.unpack(header)
+            sizes = f.read(4 * count)
+            if magic != CHUNK_MAGIC or len(sizes) < 4 * count:
+                return
+            length = sum(struct.unpack("<%dI" % count, sizes))
+            if offset + CHUNK.size + 4 * count + length > os.path.getsize(path):
+                return      # partly written chunk at the end
+            f.seek(length, os.SEEK_CUR)
+            yield first, last, offset, rows
+
+
+class Reader:
+    def __init__(self, path):
+        self.path = path
+        self.data = open(path, "rb")
+        if self.data.read(len(MAGIC)) != MAGIC:
+            raise SystemExit("%s: not a telemetry store" % path)
+        try:
+            with open(path + ".idx", "rb") as f:
+                raw = f.read()
+            self.entries = [INDEX.unpack_from(raw, k) for k in range(0, len(raw) - INDEX.size + 1, INDEX.size)]
+        except FileNotFoundError:
+            sys.stderr.write("%s.idx missing, scanning chunk headers\n" % path)
+            self.entries = list(scan_chunks(path))
+        self.lasts = []
+        last = None
+        for entry in self.entries:
+            # running maximum, so bisect works even if a re-anchor moved time back
+            last = entry[1] if last is None else max(last, entry[1])
+            self.lasts.append(last)
+
+    def span(self):
+        if not self.entries:
+            return None, None
+        return min(e[0] for e in self.entries), self.lasts[-1]
+
+    def read_chunk(self, entry, names):
+        _, _, offset, rows = entry
+        self.data.seek(offset)
+        magic, rows, _, _, count = CHUNK.unpack(self.data.read(CHUNK.size))
+        sizes = struct.unpack("<%dI" % count, self.data.read(4 * count))
+        base = offset + CHUNK.size + 4 * count
+        starts = [base + sum(sizes[:k]) for k in range(count)]
+        columns = {}
+        for name in names:
+            k = COLUMN_INDEX[name]
+            self.data.seek(starts[k])
+            columns[name] = from_le(COLUMNS[k][1], zlib.decompress(self.data.read(sizes[k])))
+        return columns
+
+    def rows(self, t_from, t_to, names):
+        """Yield tuples of the named columns for from <= time <= to."""
+        want = list(names)
+        if "time" not in want:
+            want.append("time")
+        start = bisect.bisect_left(self.lasts, t_from) if t_from is not None else 0
+        for entry in self.entries[start:]:
+            if t_to is not None and entry[0] > t_to:
+                break
+            columns = self.read_chunk(entry, want)
+            times = columns["time"]
+            lo = bisect.bisect_left(times, t_from) if t_from is not None else 0
+            hi = bisect.bisect_right(times, t_to) if t_to is not None else len(times)
+            selected = [columns[name][lo:hi] for name in names]
+            for row in zip(*selected):
+                yield row
+
+
+def parse_time(text, base):
+    if text is None:
+        return None
+    if text.startswith("+"):
+        return base + int(float(text[1:]) * 1e6)
+    return int(datetime.datetime.fromisoformat(text).timestamp() * 1e6)
+
+
+def format_time(us):
+    return datetime.datetime.fromtimestamp(us / 1e6).isoformat(timespec="milliseconds")
+
+
+def open_source(path, baud):
+    """File descriptor of the source; a tty is put into raw mode at baud."""
+    if path == "-":
+        return sys.stdin.fileno(), False
+    fd = os.open(path, os.O_RDONLY | os.O_NOCTTY)
+    if os.isatty(fd):
+        import termios
+        import tty
+        tty.setraw(fd)
+        attrs = termios.tcgetattr(fd)
+        speed = getattr(termios, "B%d" % baud)
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+        return fd, True
+    return fd, stat.S_ISFIFO(os.fstat(fd).st_mode)
+
+
+def record(args):
+    fd, live = open_source(args.source, args.baud)
+    if args.start:
+        start = parse_time(args.start, 0)
+    elif not live and args.source != "-":
+        start = int(os.fstat(fd).st_mtime * 1e6)
+    else:
+        start = int(time.time() * 1e6)
+    clock = DeviceClock(live, start)
+    decoder = Decoder()
+    writer = Writer(args.store)
+    last_flush = time.monotonic()
+    frames = 0
+    began = time.monotonic()
+    try:
+        while True:
+            if live:
+                ready, _, _ = select.select([fd], [], [], 1.0)
+                data = os.read(fd, 65536) if ready else b""
+                if ready and not data:
+                    break       # writer side of a pipe or pty closed
+            else:
+                data = os.read(fd, 1 << 20)
+                if not data:
+                    break
+            now = int(time.time() * 1e6)
+            for sample in decoder.feed(data):
+                writer.append(clock.convert(sample[1], now), sample)
+                frames += 1
+            if live and time.monotonic() - last_flush >= args.flush:
+                writer.flush()
+                last_flush = time.monotonic()
+    except KeyboardInterrupt:
+        pass
+    writer.close()
+    elapsed = time.monotonic() - began
+    sys.stderr.write("%d frames (%.0f/s), %d missing, %d bad, %d chunks written\n" % (
+        frames, frames / elapsed if elapsed > 0 else 0, decoder.missing, decoder.bad, writer.chunks))
+
+
+def reindex(args):
+    entries = list(scan_chunks(args.store))
+    with open(args.store + ".idx", "wb") as f:
+        for entry in entries:
+            f.write(INDEX.pack(*entry))
+    print("%d chunks indexed" % len(entries))
+
+
+def info(args):
+    reader = Reader(args.store)
+    first, last = reader.span()
+    rows = sum(e[3] for e in reader.entries)
+    print("%s: %d chunks, %d samples, %d bytes" % (args.store, len(reader.entries), rows,
+                                                  os.path.getsize(args.store)))
+    if rows:
+        print("from %s to %s (%.1f h)" % (format_time(first), format_time(last), (last - first) / 3.6e9))
+
+
+def query(args):
+    reader = Reader(args.store)
+    first, _ = reader.span()
+    if first is None:
+        return
+    names = args.columns.split(",") if args.columns else [name for name, _ in COLUMNS]
+    for name in names:
+        if name not in COLUMN_INDEX:
+            raise SystemExit("unknown column %s" % name)
+    out = sys.stdout
+    out.write(",".join(names) + "\n")
+    for row in reader.rows(parse_time(args.t_from, first), parse_time(args.t_to, first), names):
+        fields = []
+        for name, value in zip(names, row):
+            if name == "time":
+                fields.append("%.6f" % (value / 1e6))
+            elif name in Q16_COLUMNS:
+                fields.append("%.3f" % q16(value))
+            else:
+                fields.append(str(value))
+        out.write(",".join(fields) + "\n")
+
+
+def counter_delta(previous, current):
+    """Increments of the wrapping 16-bit counters between two samples.
+
+    A decrease of more than half the range is a board reset, which starts
+    the counters from zero again.
+    """
+    if previous is None:
+        return (0,) * len(current)
+    deltas = [(c - p) & 0xFFFF for p, c in zip(previous, current)]
+    if any(d >= 0x8000 for d in deltas):
+        return tuple(current)
+    return tuple(deltas)
+
+
+class Step:
+    """KPIs of one setpoint step, accumulated sample by sample."""
+
+    def __init__(self, t0, y0, target, band_pct, band_pa):
+        self.t0 = t0
+        self.y0 = y0
+        self.retarget(target, band_pct, band_pa)
+        self.samples = 0
+        self.transactions = 0
+        self.errors = 0
+        self.iae = 0.0
+        self.last_t = t0
+        self.t10 = self.t90 = None
+        self.peak = 0.0
+        self.outside = True
+        self.entered = None
+
+    def retarget(self, target, band_pct, band_pa):
+        self.target = target
+        self.delta = target - self.y0
+        self.band = max(abs(self.delta) * band_pct / 100.0, band_pa)
+
+    def add(self, t, y, transactions, errors):
+        """transactions and errors: drive transactions since the previous sample"""
+        error = self.target - y
+        self.iae += abs(error) * min(t - self.last_t, 1000000) / 1e6
+        self.last_t = t
+        self.samples += 1
+        self.transactions += transactions
+        self.errors += errors
+        if self.delta != 0:
+            progress = (y - self.y0) / self.delta
+            if self.t10 is None and progress >= 0.1:
+                self.t10 = t
+            if self.t90 is None and progress >= 0.9:
+                self.t90 = t
+            self.peak = max(self.peak, (progress - 1.0) * 100.0)
+        if abs(error) > self.band:
+            self.outside = True
+        elif self.outside:
+            self.outside = False
+            self.entered = t
+
+    def result(self, min_step):
+        step = abs(self.delta) >= min_step
+
+        def seconds(us):
+            return "%.2f" % (us / 1e6) if us is not None else "-"
+
+        rise = self.t90 - self.t10 if step and self.t10 is not None and self.t90 is not None else None
+        settle = self.entered - self.t0 if not self.outside and self.entered is not None else None
+        return (format_time(self.t0), "%.1f" % self.y0, "%d" % self.target, "%.1f" % self.delta,
+                seconds(rise), "%.1f" % self.peak if step else "-", seconds(settle),
+                "%.2f" % self.iae,
+                "%.1f" % (100.0 * self.errors / self.transactions) if self.transactions else "-",
+                seconds(self.last_t - self.t0), str(self.samples))
+
+
+def kpi(args):
+    reader = Reader(args.store)
+    first, _ = reader.span()
+    if first is None:
+        return
+    header = ("start", "from Pa", "to Pa", "step", "rise s", "overshoot %", "settle s",
+              "IAE Pa*s", "modbus err %", "length s", "samples")
+    widths = (23, 8, 6, 6, 7, 11, 8, 9, 12, 8, 8)
+    line = "  ".join("%*s" % (w, h) for w, h in zip(widths, header))
+    print(line)
+    step = None
+    last_change = None
+    debounce = int(args.debounce * 1e6)
+    names = ("time", "setpoint", "pascal", "transactions", "errors", "flags")
+    counts = None
+    for t, setpoint, pascal, transactions, errors, flags in reader.rows(parse_time(args.t_from, first),
+                                                                         parse_time(args.t_to, first), names):
+        y = q16(pascal)
+        new = counter_delta(counts, (transactions, errors))
+        counts = (transactions, errors)
+        if not flags & FLAG_AUTOMATIC:
+            if step is not None:
+                print("  ".join("%*s" % (w, v) for w, v in zip(widths, step.result(args.min_step))))
+            step = None
+            continue
+        if step is not None and setpoint != step.target:
+            if t - last_change < debounce:
+                # setpoint still moving (button held): one step to the final value
+                step.retarget(setpoint, args.band, args.band_pa)
+                last_change = t
+            else:
+                print("  ".join("%*s" % (w, v) for w, v in zip(widths, step.result(args.min_step))))
+                step = None
+        if step is None:
+            step = Step(t, y, setpoint, args.band, args.band_pa)
+            last_change = t
+        step.add(t, y, *new)
+    if step is not None:
+        print("  ".join("%*s" % (w, v) for w, v in zip(widths, step.result(args.min_step))))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    p = commands.add_parser("record", help="decode a telemetry stream into a store")
+    p.add_argument("source", help="serial device, pty, fifo, capture file or - for stdin")
+    p.add_argument("store")
+    p.add_argument("--baud", type=int, default=115200)
+    p.add_argument("--flush", type=float, default=10.0, help="seconds between chunk writes when live")
+    p.add_argument("--start", help="ISO date/time of the first sample of a capture file (default: its mtime)")
+    p.set_defaults(func=record)
+
+    p = commands.add_parser("info", help="chunks and time span of a store")
+    p.add_argument("store")
+    p.set_defaults(func=info)
+
+    p = commands.add_parser("reindex", help="rebuild the index from the chunk headers")
+    p.add_argument("store")
+    p.set_defaults(func=reindex)
+
+    for name, func, text in (("query", query, "samples in a time range as CSV"),
+                             ("kpi", kpi, "control KPIs per setpoint step")):
+        p = commands.add_parser(name, help=text)
+        p.add_argument("store")
+        p.add_argument("--from", dest="t_from", help="ISO date/time or +seconds from the first sample")
+        p.add_argument("--to", dest="t_to", help="ISO date/time or +seconds from the first sample")
+        p.set_defaults(func=func)
+        if name == "query":
+            p.add_argument("--columns", help="comma separated, default all: " +
+                           ",".join(n for n, _ in COLUMNS))
+        else:
+            p.add_argument("--band", type=float, default=5.0, help="settling band, %% of the step")
+            p.add_argument("--band-pa", type=float, default=1.0, help="minimum settling band, Pa")
+            p.add_argument("--min-step", type=float, default=2.0,
+                           help="smaller steps get no rise time or overshoot, Pa")
+            p.add_argument("--debounce", type=float, default=1.0,
+                           help="setpoint changes closer than this merge into one step, s")
+
+    args = parser.parse_args()
+    try:
+        args.func(args)
+    except BrokenPipeError:
+        # output piped into head and the like; silence the flush at exit
+        os.dup2(os.open(os.devnull, os.O_WRONLY), sys.stdout.fileno())
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,137 @@
+/*
+ * tunertest.cpp
+ *
+ *  Created on: 19.10.2026
+ *
+ * Host harness for src/RelayAutoTuner.h. The duct is modelled as a
+ * first-order-plus-dead-time plant, pressure = K * speed delayed by L and
+ * lagged by T, simulated in 1 ms steps; the tuner is updated at the
+ * firmware's 50 Hz control rate. The relay experiment is run through
+ * start()/update() to DONE and the measured Ku and Pu are compared with
+ * the exact relay oscillation of that plant. The resulting gains then
+ * close the loop with PidController for a setpoint step, which has to
+ * settle.
+ *
+ *     g++ -std=c++11 -O2 -Wall -I../src tunertest.cpp -o tunertest && ./tunertest
+ */
+
+#include "RelayAutoTuner.h"
+#include "PidController.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static const double PI = 3.14159265358979;
+static const uint32_t CONTROL_MS = 20;		// 50 Hz, as CONTROL_RATE
+
+class FopdtPlant {
+public:
+	FopdtPlant(double gain, double lagS, double deadS, double speed) :
+		gain(gain), lagS(lagS), delayed((size_t)(deadS * 1000 + 0.5), speed), head(0), y(gain * speed) {}
+
+	/* advance 1 ms with the given fan speed, returns the pressure in Pa */
+	double step(double speed) {
+		double u = speed;
+		if(!delayed.empty()) {
+			u = delayed[head];
+			delayed[head] = speed;
+			if(++head == delayed.size()) head = 0;
+		}
+		y += (gain * u - y) * (1 - exp(-0.001 / lagS));
+		return y;
+	}
+	double pressure() const { return y; }
+private:
+	double gain, lagS;
+	std::vector<double> delayed;
+	size_t head;
+	double y;
+};
+
+struct Case {
+	double gain;		// Pa per % fan speed
+	double lagS;
+	double deadS;
+};
+
+static bool near(const char *what, double got, double expected, double tolerance) {
+	bool ok = fabs(got - expected) <= tolerance * fabs(expected);
+	printf("  %-10s %10.5f  expected %10.5f%s\n", what, got, expected, ok ? "" : "  <-- FAIL");
+	return ok;
+}
+
+static bool run(const Case &c) {
+	const double setpoint = 50, amplitude = 10, hysteresis = 0.5;
+	const double bias = setpoint / c.gain;
+	FopdtPlant plant(c.gain, c.lagS, c.deadS, bias);
+	RelayAutoTuner<> tuner;
+	Q16 speed;
+	uint32_t ms = 0;
+	bool ok = true;
+
+	printf("K %.2f Pa/%%, T %.2f s, L %.2f s\n", c.gain, c.lagS, c.deadS);
+	tuner.start(Q16::fromFloat(setpoint), Q16::fromFloat(bias), Q16::fromFloat(amplitude),
+			Q16::fromFloat(hysteresis), ms, 120000);
+	speed = tuner.update(Q16::fromFloat(plant.pressure()), ms);
+	while(tuner.getState() == RelayAutoTuner<>::RUNNING) {
+		for(uint32_t i = 0; i < CONTROL_MS; i++) plant.step(speed.toFloat());
+		ms += CONTROL_MS;
+		speed = tuner.update(Q16::fromFloat(plant.pressure()), ms);
+	}
+	if(tuner.getState() != RelayAutoTuner<>::DONE) {
+		printf("  tuner failed after %u ms\n", ms);
+		return false;
+	}
+
+	/* Exact limit cycle: after the relay switches at setpoint + h the
+	 * pressure keeps rising for L, then falls towards -K d until it crosses
+	 * setpoint - h. A switch is only seen at the next control step, which
+	 * adds half a step to the dead time on average. */
+	double kd = c.gain * amplitude;
+	double dead = c.deadS + CONTROL_MS / 2000.0;
+	double peak = kd - (kd - hysteresis) * exp(-dead / c.lagS);
+	double half = dead + c.lagS * log((peak + kd) / (kd - hysteresis));
+	double pu = 2 * half * 1000;
+	double ku = 4 * amplitude / (PI * peak);
+
+	ok &= near("Pu ms", tuner.getUltimatePeriod(), pu, 0.03);
+	ok &= near("Ku", tuner.getUltimateGain().toFloat(), ku, 0.05);
+	ok &= near("Kp", tuner.getKp().toFloat(), tuner.getUltimateGain().toFloat() / 3, 0.01);
+	ok &= near("Ki", tuner.getKi().toFloat(), tuner.getKp().toFloat() * 2 / tuner.getUltimatePeriod(), 0.02);
+	ok &= near("Kd", tuner.getKd().toFloat(), tuner.getKp().toFloat() * tuner.getUltimatePeriod() / 3, 0.01);
+
+	/* close the loop with the new gains: step 50 -> 60 Pa */
+	PidController<> pid(tuner.getKp(), tuner.getKi(), tuner.getKd());
+	const double target = 60;
+	double maxPressure = 0;
+	uint32_t settled = 0;
+	pid.setManual(Q16::fromFloat(bias));
+	pid.setAutomatic();
+	for(ms = 0; ms < 60000; ms += CONTROL_MS) {
+		speed = pid.update(Q16::fromFloat(target), Q16::fromFloat(plant.pressure()), CONTROL_MS);
+		for(uint32_t i = 0; i < CONTROL_MS; i++) plant.step(speed.toFloat());
+		if(plant.pressure() > maxPressure) maxPressure = plant.pressure();
+		if(fabs(plant.pressure() - target) > 0.02 * target) settled = ms + CONTROL_MS;
+	}
+	double overshoot = (maxPressure - target) / (target - setpoint) * 100;
+	printf("  step       overshoot %.0f %%, settled within 2 %% after %.1f s\n", overshoot, settled / 1000.0);
+	if(settled > 30000 || overshoot > 80) {
+		printf("  closed loop does not settle  <-- FAIL\n");
+		ok = false;
+	}
+	return ok;
+}
+
+int main() {
+	static const Case cases[] = {
+		{ 1.25, 1.0, 0.3 },
+		{ 0.6, 2.0, 0.2 },
+		{ 2.0, 0.5, 0.5 },
+	};
+	bool ok = true;
+
+	for(unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) ok &= run(cases[i]);
+	printf(ok ? "all ok\n" : "FAILED\n");
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}